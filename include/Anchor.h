@@ -0,0 +1,153 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "DocStore.h"
+
+// ---------------------------------------------------------------------------
+// Reading anchor: a layout-independent position in the document.
+// Char offsets stop meaning anything once the text size changes or the
+// content is refreshed, so the current page is remembered as a line number,
+// an offset into that line and fingerprints of the line's text and of the
+// nearest non-blank lines before and after it. Blank lines, "}" or "---"
+// look alike on their own; with their neighbours they are told apart. After
+// re-layout the anchor is resolved back to a char offset and from there to
+// a page through the page index.
+// ---------------------------------------------------------------------------
+#define ANCHOR_FP_BYTES  64   // leading bytes of a line that make up its fingerprint
+#define ANCHOR_FP_BLANK  2166136261u  // fingerprint of an empty line (FNV-1a of nothing)
+#define ANCHOR_SEARCH    256  // lines searched either side when the line moved
+#define ANCHOR_SKIP      16   // blank lines skipped looking for a neighbour
+#define LINE_INDEX_STRIDE 32  // every 32nd line start is kept; the rest are found by scanning
+
+struct ReadAnchor {
+  int      line;    // 0-based line number
+  int      col;     // char offset into the line
+  uint32_t fp;      // FNV-1a of the line's first ANCHOR_FP_BYTES
+  uint32_t before;  // ... of the nearest non-blank line above (ANCHOR_FP_BLANK if none)
+  uint32_t after;   // ... and below
+};
+
+// Index of the last element <= value in a sorted offset table (binary search)
+static int wcFindSlot(const std::vector<int> &table, int value) {
+  int lo = 0, hi = (int)table.size() - 1;
+  while (lo < hi) {
+    int mid = (lo + hi + 1) / 2;
+    if (table[mid] <= value) lo = mid;
+    else                     hi = mid - 1;
+  }
+  return lo;
+}
+
+// Sparse line index: keeps the start offset of every LINE_INDEX_STRIDE-th line
+// and finds the others with a short memchr scan, so a document of tens of
+// thousands of lines (e.g. mapped from flash) doesn't need a RAM table entry
+// per line.
+class LineIndex {
+public:
+  void build(const DocStore &body) {
+    _body  = &body;
+    _count = 1;
+    _marks.clear();
+    _marks.push_back(0);
+    for (int i = body.indexOf('\n', 0); i >= 0; i = body.indexOf('\n', i + 1)) {
+      if (_count % LINE_INDEX_STRIDE == 0) _marks.push_back(i + 1);
+      _count++;
+    }
+  }
+
+  int count() const { return _count; }
+
+  // Char offset where line starts
+  int start(int line) const {
+    int off = _marks[line / LINE_INDEX_STRIDE];
+    for (int k = line % LINE_INDEX_STRIDE; k > 0; k--) off = _body->indexOf('\n', off) + 1;
+    return off;
+  }
+
+  // Char offset of the end of line (its '\n', or the end of the body)
+  int end(int line) const {
+    int e = _body->indexOf('\n', start(line));
+    return e < 0 ? _body->length() : e;
+  }
+
+  // Line holding char offset
+  int lineOf(int offset) const {
+    int m    = wcFindSlot(_marks, offset);
+    int line = m * LINE_INDEX_STRIDE;
+    int off  = _marks[m];
+    for (;;) {
+      int nl = _body->indexOf('\n', off);
+      if (nl < 0 || nl >= offset) return line;
+      line++;
+      off = nl + 1;
+    }
+  }
+
+private:
+  const DocStore  *_body  = nullptr;
+  std::vector<int> _marks;
+  int              _count = 0;
+};
+
+static uint32_t wcLineFingerprint(const DocStore &body, const LineIndex &lines, int line) {
+  int start = lines.start(line);
+  int end   = lines.end(line);
+  if (end - start > ANCHOR_FP_BYTES) end = start + ANCHOR_FP_BYTES;
+  uint32_t h = ANCHOR_FP_BLANK;
+  for (int i = start; i < end; i++) {
+    char c = body[i];
+    if (c == '\r') continue;  // CRLF and LF versions of a line match
+    h = (h ^ (uint8_t)c) * 16777619u;
+  }
+  return h;
+}
+
+// Fingerprint of the nearest non-blank line from line + step on, going by step
+static uint32_t wcNeighbourFingerprint(const DocStore &body, const LineIndex &lines, int line, int step) {
+  for (int k = 1, l = line + step; k <= ANCHOR_SKIP && l >= 0 && l < lines.count(); k++, l += step) {
+    uint32_t fp = wcLineFingerprint(body, lines, l);
+    if (fp != ANCHOR_FP_BLANK) return fp;
+  }
+  return ANCHOR_FP_BLANK;
+}
+
+// How well line matches the anchor: 3 = the line and both neighbours,
+// 2 = the line and one neighbour, 1 = only the line, and that not blank
+static int wcAnchorScore(const DocStore &body, const LineIndex &lines, int line, const ReadAnchor &a) {
+  if (wcLineFingerprint(body, lines, line) != a.fp) return 0;
+  int score = 1 + (wcNeighbourFingerprint(body, lines, line, -1) == a.before) +
+                  (wcNeighbourFingerprint(body, lines, line, 1) == a.after);
+  return score == 1 && a.fp == ANCHOR_FP_BLANK ? 0 : score;
+}
+
+static ReadAnchor wcCaptureAnchor(const DocStore &body, const LineIndex &lines, int offset) {
+  ReadAnchor a;
+  a.line   = lines.lineOf(offset);
+  a.col    = offset - lines.start(a.line);
+  a.fp     = wcLineFingerprint(body, lines, a.line);
+  a.before = wcNeighbourFingerprint(body, lines, a.line, -1);
+  a.after  = wcNeighbourFingerprint(body, lines, a.line, 1);
+  return a;
+}
+
+// Map an anchor onto a (possibly different) body and return its char offset.
+// Takes the nearest line, same line number first, that matches with both
+// neighbours; failing that the nearest with one, then the nearest non-blank
+// line that matches alone. With no match at all it keeps the line number,
+// clamped to the end.
+static int wcResolveAnchor(const DocStore &body, const LineIndex &lines, const ReadAnchor &a) {
+  int n       = lines.count();
+  int best[4] = { -1, -1, -1, -1 };  // nearest line per score
+  for (int d = 0; d <= ANCHOR_SEARCH && best[3] < 0; d++) {
+    for (int line = a.line - d; line <= a.line + d; line += max(2 * d, 1)) {
+      if (line < 0 || line >= n) continue;
+      int score = wcAnchorScore(body, lines, line, a);
+      if (best[score] < 0) best[score] = line;
+    }
+  }
+  int line = best[3] >= 0 ? best[3] : best[2] >= 0 ? best[2] : best[1];
+  if (line < 0) return lines.start(min(a.line, n - 1));  // text is gone: same line number, start of line
+
+  return min(lines.start(line) + a.col, lines.end(line));
+}
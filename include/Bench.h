@@ -0,0 +1,141 @@
+#pragma once
+
+#include <Arduino.h>
+#include <stdarg.h>
+#include "DocStore.h"
+
+// ---------------------------------------------------------------------------
+// Self-benchmark: a fixed suite run on the board itself, so two firmware
+// builds can be compared on the same CYD with the real SPI bus, flash and
+// WiFi stack (host benchmarks in tools/ see none of these). Started with the
+// `bench [url]` console command or GET /bench on the push server; the suite
+// itself is runBench() in main.cpp.
+//
+// Results are one line per measurement, easy to grep out of a serial log
+// and to diff between builds (tools/benchcmp.py):
+//
+//   #BENCH <stage> key=value ... heap=<free> maxblk=<largest free block>
+//
+// Every line ends with the heap as it stands after that stage. The test
+// document is generated from a fixed seed, so every run lays out the same
+// bytes.
+// ---------------------------------------------------------------------------
+#define BENCH_DOC_BYTES (48 * 1024)
+#define BENCH_REPEAT    5      // draws and clears are averaged over this many
+#define BENCH_TOUCH_MS  250    // touch controller read rate window
+#define BENCH_TLS_REPEAT 3     // handshakes per TLS mode
+
+// Echoes everything to Serial and, for an HTTP request, into a String
+class BenchLog : public Print {
+public:
+  explicit BenchLog(String *copy = nullptr) : _copy(copy) {}
+
+  size_t write(uint8_t c) override {
+    Serial.write(c);
+    if (_copy) *_copy += (char)c;
+    return 1;
+  }
+
+  // One result line for stage; fmt gives the key=value fields
+  void result(const char *stage, const char *fmt, ...) __attribute__((format(printf, 3, 4))) {
+    char fields[160];
+    va_list ap;
+    va_start(ap, fmt);
+    vsnprintf(fields, sizeof(fields), fmt, ap);
+    va_end(ap);
+    printf("#BENCH %s %s heap=%u maxblk=%u\n", stage, fields, ESP.getFreeHeap(), ESP.getMaxAllocHeap());
+  }
+
+private:
+  String *_copy;
+};
+
+// Lowest free heap while something runs on this core, sampled every tick
+// by a task on the other one: the peak a TLS handshake needs, which the
+// heap left once it is done doesn't show
+class HeapWatch {
+public:
+  void start() {
+    _run  = true;
+    _done = false;
+    xTaskCreatePinnedToCore(sample, "heapwatch", 2048, this, 1, nullptr, 1 - xPortGetCoreID());
+    _base = _low = ESP.getFreeHeap();  // after the task's own stack
+  }
+
+  // Stop sampling; returns the most heap in use above the start
+  uint32_t stop() {
+    _run = false;
+    while (!_done) delay(1);
+    return _base - min((uint32_t)_low, (uint32_t)_base);
+  }
+
+private:
+  static void sample(void *arg) {
+    HeapWatch *w = (HeapWatch *)arg;
+    while (w->_run) {
+      uint32_t f = ESP.getFreeHeap();
+      if (f < w->_low) w->_low = f;
+      vTaskDelay(1);
+    }
+    w->_done = true;
+    vTaskDelete(nullptr);
+  }
+
+  volatile bool     _run = false, _done = true;
+  volatile uint32_t _low = 0;
+  uint32_t          _base = 0;
+};
+
+// Fill doc with BENCH_DOC_BYTES of the shapes the viewer meets: prose with
+// long paragraphs, log lines, indented code, CSV-ish rows, blank-line runs
+// and the odd line far wider than the screen
+static void wcBenchText(DocStore &doc) {
+  static const char *const WORDS[] = {
+    "the", "status", "of", "build", "server", "is", "green", "deploy", "queued", "for",
+    "release", "branch", "main", "latency", "p99", "under", "budget", "cache", "warm", "ok",
+  };
+  const int nWords = sizeof(WORDS) / sizeof(WORDS[0]);
+  uint32_t seed = 12345;
+  auto rnd = [&seed](int n) {
+    seed = seed * 1103515245 + 12345;  // fixed LCG: the same text on every build
+    return (int)((seed >> 16) % n);
+  };
+
+  char line[400];
+  int  n = 0;
+  while (doc.length() < BENCH_DOC_BYTES) {
+    int len = 0;
+    switch (rnd(8)) {
+      case 0: case 1: case 2:  // prose paragraph
+        for (int w = 20 + rnd(40); w > 0 && len < 300; w--) {
+          len += snprintf(line + len, sizeof(line) - len, "%s ", WORDS[rnd(nWords)]);
+        }
+        break;
+      case 3: case 4:          // log line
+        len = snprintf(line, sizeof(line), "2024-05-01 12:%02d:%02d web-%02d GET /api/v1/items/%d 200 %d ms",
+                       rnd(60), rnd(60), rnd(8), rnd(100000), rnd(900));
+        break;
+      case 5:                  // code
+        len = snprintf(line, sizeof(line), "%*sif (%s_%d > %d) return %s;", 2 * rnd(4), "",
+                       WORDS[rnd(nWords)], rnd(10), rnd(1000), WORDS[rnd(nWords)]);
+        break;
+      case 6:                  // table row
+        len = snprintf(line, sizeof(line), "%d,%s,%d.%02d,%s", n, WORDS[rnd(nWords)], rnd(100), rnd(100),
+                       WORDS[rnd(nWords)]);
+        break;
+      default:                 // blank lines or one very long token
+        if (rnd(2)) {
+          len = rnd(3);
+          memset(line, '\n', len);
+        } else {
+          len = 200 + rnd(150);
+          for (int i = 0; i < len; i++) line[i] = 'a' + rnd(26);
+        }
+        break;
+    }
+    line[len++] = '\n';
+    doc.append((const uint8_t *)line, min(len, BENCH_DOC_BYTES - doc.length()));
+    n++;
+  }
+  doc.seal();
+}
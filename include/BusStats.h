@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Arduino_GFX_Library.h>
+
+// ---------------------------------------------------------------------------
+// Counting data bus: sits between Arduino_GFX and the real bus, forwards every
+// call unchanged and tallies what went over the wire. The counters are how we
+// measure render optimizations: commands, pixels and bytes pushed per frame.
+// ---------------------------------------------------------------------------
+struct BusCounters {
+  uint32_t transactions;  // beginWrite() .. endWrite() pairs
+  uint32_t commands;      // command bytes (address window, RAMWR, ...)
+  uint32_t pixels;        // RGB565 pixels in bulk pixel writes
+  uint32_t bytes;         // everything clocked out, commands included
+};
+
+class CountingBus : public Arduino_DataBus {
+public:
+  BusCounters frame;  // since the last resetFrame()
+  BusCounters total;  // since boot
+
+  CountingBus(Arduino_DataBus *bus) : _bus(bus) {
+    memset(&frame, 0, sizeof(frame));
+    memset(&total, 0, sizeof(total));
+  }
+
+  void resetFrame() { memset(&frame, 0, sizeof(frame)); }
+
+  bool begin(int32_t speed = GFX_NOT_DEFINED, int8_t dataMode = GFX_NOT_DEFINED) override {
+    return _bus->begin(speed, dataMode);
+  }
+  void beginWrite() override               { count(1, 0, 0, 0); _bus->beginWrite(); }
+  void endWrite() override                 { _bus->endWrite(); }
+  void writeCommand(uint8_t c) override    { count(0, 1, 0, 1); _bus->writeCommand(c); }
+  void writeCommand16(uint16_t c) override { count(0, 1, 0, 2); _bus->writeCommand16(c); }
+  void write(uint8_t d) override           { count(0, 0, 0, 1); _bus->write(d); }
+  void write16(uint16_t d) override        { count(0, 0, 0, 2); _bus->write16(d); }
+
+  void writeC8D8(uint8_t c, uint8_t d) override                    { count(0, 1, 0, 2); _bus->writeC8D8(c, d); }
+  void writeC8D16(uint8_t c, uint16_t d) override                  { count(0, 1, 0, 3); _bus->writeC8D16(c, d); }
+  void writeC8D16D16(uint8_t c, uint16_t d1, uint16_t d2) override { count(0, 1, 0, 5); _bus->writeC8D16D16(c, d1, d2); }
+
+  void writeRepeat(uint16_t p, uint32_t len) override     { count(0, 0, len, len * 2); _bus->writeRepeat(p, len); }
+  void writePixels(uint16_t *data, uint32_t len) override { count(0, 0, len, len * 2); _bus->writePixels(data, len); }
+  void writeBytes(uint8_t *data, uint32_t len) override   { count(0, 0, 0, len); _bus->writeBytes(data, len); }
+  void writePattern(uint8_t *data, uint8_t len, uint32_t repeat) override {
+    count(0, 0, 0, (uint32_t)len * repeat);
+    _bus->writePattern(data, len, repeat);
+  }
+  void writeIndexedPixels(uint8_t *data, uint16_t *idx, uint32_t len) override {
+    count(0, 0, len, len * 2);
+    _bus->writeIndexedPixels(data, idx, len);
+  }
+  void writeIndexedPixelsDouble(uint8_t *data, uint16_t *idx, uint32_t len) override {
+    count(0, 0, len * 2, len * 4);
+    _bus->writeIndexedPixelsDouble(data, idx, len);
+  }
+
+private:
+  Arduino_DataBus *_bus;
+
+  void count(uint32_t t, uint32_t c, uint32_t p, uint32_t b) {
+    frame.transactions += t; frame.commands += c; frame.pixels += p; frame.bytes += b;
+    total.transactions += t; total.commands += c; total.pixels += p; total.bytes += b;
+  }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <esp_sntp.h>
+#include <sys/time.h>
+
+// ---------------------------------------------------------------------------
+// Wall clock that never blocks. getLocalTime() waits up to 5 s for SNTP when
+// the time isn't set yet, which froze every page turn until the first sync.
+// Instead the SNTP sync callback stores the epoch together with millis() at
+// that moment, and the current time is worked out from the two: no waiting,
+// no system calls. Before the first sync there is simply no time to show.
+// SNTP resyncs hourly, which keeps millis() drift well under a minute.
+// ---------------------------------------------------------------------------
+#define CLOCK_UNSYNCED_MS 5000  // idle wakeup while still waiting for SNTP
+
+static portMUX_TYPE clock_mux     = portMUX_INITIALIZER_UNLOCKED;
+static time_t       clock_epoch   = 0;  // seconds since 1970 at clock_sync_ms, 0 = not synced
+static uint32_t     clock_sync_ms = 0;
+
+static void wcClockSet(time_t epoch, uint32_t ms) {
+  portENTER_CRITICAL(&clock_mux);
+  clock_epoch   = epoch;
+  clock_sync_ms = ms;
+  portEXIT_CRITICAL(&clock_mux);
+}
+
+// Runs in the lwIP task after SNTP has set the system time
+static void wcClockSynced(struct timeval *tv) {
+  uint32_t ms = millis() - tv->tv_usec / 1000;  // millis() when the second started
+  wcClockSet(tv->tv_sec, ms);
+  Serial.printf("[Clock] SNTP sync, epoch %ld\n", (long)tv->tv_sec);
+}
+
+// Call once WiFi is up. Returns immediately; the first sync arrives later.
+static void wcClockBegin() {
+  struct timeval tv;
+  gettimeofday(&tv, nullptr);
+  if (tv.tv_sec > 1600000000) wcClockSet(tv.tv_sec, millis() - tv.tv_usec / 1000);  // kept across a soft reset
+  sntp_set_time_sync_notification_cb(wcClockSynced);
+  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
+}
+
+// Current UTC minute since 1970, or -1 before the first sync
+static int32_t wcClockMinute() {
+  portENTER_CRITICAL(&clock_mux);
+  time_t   epoch = clock_epoch;
+  uint32_t since = millis() - clock_sync_ms;
+  portEXIT_CRITICAL(&clock_mux);
+  if (!epoch) return -1;
+  return (int32_t)((epoch + since / 1000) / 60);
+}
+
+// Milliseconds until the minute changes, for the idle/sleep budget
+static uint32_t wcClockWait() {
+  portENTER_CRITICAL(&clock_mux);
+  time_t   epoch = clock_epoch;
+  uint32_t since = millis() - clock_sync_ms;
+  portEXIT_CRITICAL(&clock_mux);
+  if (!epoch) return CLOCK_UNSYNCED_MS;
+  uint32_t intoMinute = (uint32_t)(epoch % 60) * 1000 + since % 60000;
+  return 60000 - intoMinute % 60000;
+}
+
+// "HH:MM UTC" for a minute from wcClockMinute()
+static void wcClockFormat(int32_t minute, char *buf, size_t len) {
+  int m = minute % (24 * 60);
+  snprintf(buf, len, "%02d:%02d UTC", m / 60, m % 60);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ---------------------------------------------------------------------------
+// Serial console: reads a line from Serial without blocking and dispatches it
+// to a command table. The first word selects the command, the rest of the
+// line is passed on as its arguments.
+// ---------------------------------------------------------------------------
+#define CONSOLE_LINE_MAX 96
+
+struct ConsoleCommand {
+  const char *name;
+  const char *help;
+  void      (*run)(const char *args);
+};
+
+static char console_line[CONSOLE_LINE_MAX];
+static int  console_len = 0;
+
+static void wcConsoleHelp(const ConsoleCommand *cmds, int count) {
+  for (int i = 0; i < count; i++) Serial.printf("  %-12s %s\n", cmds[i].name, cmds[i].help);
+}
+
+static void wcConsoleRun(const ConsoleCommand *cmds, int count, char *line) {
+  while (*line == ' ') line++;
+  if (!*line) return;
+  char *args = line + strcspn(line, " ");
+  if (*args) *args++ = '\0';
+  while (*args == ' ') args++;
+
+  for (int i = 0; i < count; i++) {
+    if (strcmp(line, cmds[i].name) == 0) {
+      cmds[i].run(args);
+      return;
+    }
+  }
+  Serial.printf("[Console] unknown command '%s', try:\n", line);
+  wcConsoleHelp(cmds, count);
+}
+
+// Call from loop(); runs at most one complete line per call
+static void wcConsolePoll(const ConsoleCommand *cmds, int count) {
+  while (Serial.available()) {
+    char c = Serial.read();
+    if (c == '\r' || c == '\n') {
+      if (console_len == 0) continue;
+      console_line[console_len] = '\0';
+      console_len = 0;
+      wcConsoleRun(cmds, count, console_line);
+      return;
+    }
+    if (console_len < CONSOLE_LINE_MAX - 1) console_line[console_len++] = c;
+  }
+}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "DocStore.h"
+#include "Anchor.h"
+#include "Ingest.h"
+#include "Highlight.h"
+#include "Layout.h"
+#include "PagePack.h"
+
+// ---------------------------------------------------------------------------
+// Panes: a document together with its own layout state, drawn into one
+// rectangle of the screen. The normal single-file view is one pane covering
+// the whole text area. In dashboard mode (wc_dash_layout, Portal.h) the area
+// is tiled into 2-4 panes, each with its own feed, text size and color, and
+// each is laid out, paged and redrawn on its own: a feed that changes
+// repaints only its own rectangle.
+// ---------------------------------------------------------------------------
+#define DASH_MAX_PANES 4
+#define PANE_GAP       3   // between panes, with a 1 px rule in the middle
+
+// Page tables already laid out for this document, one per text size. Keyed by
+// the document hash so switching sizes back and forth skips the layout pass.
+struct PageTableCache {
+  bool                 valid = false;
+  uint8_t              hash[DOC_HASH_LEN];
+  std::vector<int>     pages;
+  std::vector<uint8_t> lex;
+};
+
+struct Pane {
+  int16_t x = 0, y = 0, w = 0, h = 0;  // screen rectangle
+  const char *url = "";                // feed; points at a settings buffer
+  int  textSize = 1;                   // 1..3
+  int  colorIdx = 0;                   // index into Theme::text, 6 = rainbow
+  const LexRules *lexRules = nullptr;  // lexer for the URL's extension, nullptr = plain text
+
+  DocStore             body;           // the document, in 4 KB chunks
+  LineIndex            lines;          // line starts (sparse)
+  std::vector<int>     pages;          // char offset of every page start, for the current text size
+  std::vector<uint8_t> pageLex;        // lexer state at every page start (syntax highlighting)
+  int                  page = 0;       // index into pages of the page on screen
+  uint8_t              hash[DOC_HASH_LEN];  // SHA-256 of body
+  String               etag;           // of the response now shown, sent as If-None-Match
+  PageTableCache       cache[4];       // indexed by text size 1..3
+
+  TableIndex           table;          // rows and column widths when the document is CSV/TSV
+  uint8_t              colW[TABLE_MAX_COLS];  // on-screen column widths, in chars
+  std::vector<uint8_t> colPages;       // first column of each column page (column 0 is always shown)
+  int                  colPage = 0;
+
+  bool                 packed = false; // body is a page pack: pages come straight from its tables
+  PackInfo             pack;
+};
+
+// Pane rectangles for each dashboard layout, in a 12 x 12 grid over the text area:
+// {col, row, cols, rows}
+struct PaneCell { uint8_t col, row, cols, rows; };
+static const PaneCell DASH_LAYOUTS[][DASH_MAX_PANES] = {
+  { {0, 0, 12, 12} },                                              // 0: single file
+  { {0, 0, 6, 12},  {6, 0, 6, 12} },                               // 1: two side by side
+  { {0, 0, 12, 6},  {0, 6, 12, 6} },                               // 2: two stacked
+  { {0, 0, 12, 6},  {0, 6, 6, 6},  {6, 6, 6, 6} },                 // 3: one on top, two below
+  { {0, 0, 6, 6},   {6, 0, 6, 6},  {0, 6, 6, 6},  {6, 6, 6, 6} },  // 4: 2 x 2 grid
+};
+static const uint8_t DASH_PANE_COUNT[] = { 1, 2, 2, 3, 4 };
+#define DASH_LAYOUT_COUNT (int)(sizeof(DASH_PANE_COUNT) / sizeof(DASH_PANE_COUNT[0]))
+
+// Place the panes of layout over the area (ax, ay, aw, ah). Returns the pane count.
+static int wcDashPlace(int layout, Pane *panes, int ax, int ay, int aw, int ah) {
+  layout = constrain(layout, 0, DASH_LAYOUT_COUNT - 1);
+  int n = DASH_PANE_COUNT[layout];
+  for (int i = 0; i < n; i++) {
+    const PaneCell &c = DASH_LAYOUTS[layout][i];
+    int x0 = ax + aw * c.col / 12, x1 = ax + aw * (c.col + c.cols) / 12;
+    int y0 = ay + ah * c.row / 12, y1 = ay + ah * (c.row + c.rows) / 12;
+    // leave half the gap on every inner edge
+    if (c.col)                 x0 += (PANE_GAP + 1) / 2;
+    if (c.col + c.cols < 12)   x1 -= PANE_GAP / 2 + 1;
+    if (c.row)                 y0 += (PANE_GAP + 1) / 2;
+    if (c.row + c.rows < 12)   y1 -= PANE_GAP / 2 + 1;
+    panes[i].x = x0;
+    panes[i].y = y0;
+    panes[i].w = x1 - x0;
+    panes[i].h = y1 - y0;
+  }
+  return n;
+}
+
+// Pane under a screen point, or -1
+static int wcDashPaneAt(const Pane *panes, int count, int x, int y) {
+  for (int i = 0; i < count; i++) {
+    const Pane &p = panes[i];
+    if (x >= p.x - PANE_GAP && x < p.x + p.w + PANE_GAP &&
+        y >= p.y - PANE_GAP && y < p.y + p.h + PANE_GAP) return i;
+  }
+  return -1;
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_partition.h>
+#include "DocStore.h"
+
+// ---------------------------------------------------------------------------
+// Flash document store for files too big for RAM. partitions.csv carries two
+// data partitions, doc0 and doc1. A download streams into whichever slot is
+// not on screen, so the old document stays readable until the new one is
+// complete; then the new slot is memory-mapped and the layout reads the text
+// straight out of flash through a DocStore view, with no copy in RAM.
+//
+// Wear: each slot is written only every other new document, and a sector
+// whose contents are already identical is neither erased nor rewritten, so
+// refreshing an unchanged file costs no flash writes at all.
+// ---------------------------------------------------------------------------
+#ifndef DOC_FLASH
+#define DOC_FLASH 0
+#endif
+#define DOC_PART_SUBTYPE 0x40  // custom data subtype of doc0/doc1 in partitions.csv
+
+static_assert(DOC_CHUNK == SPI_FLASH_SEC_SIZE, "the writer fills one flash sector per chunk");
+
+static const esp_partition_t *doc_parts[2] = { nullptr, nullptr };
+static int doc_flash_slot = -1;  // slot wc_body maps, -1 = none
+
+// Find the document partitions. False when the partition table doesn't have
+// them (e.g. flashed with the default table); documents then stay in RAM.
+static bool wcDocFlashBegin() {
+  const char *labels[2] = { "doc0", "doc1" };
+  for (int i = 0; i < 2; i++) {
+    doc_parts[i] = esp_partition_find_first(ESP_PARTITION_TYPE_DATA,
+                                            (esp_partition_subtype_t)DOC_PART_SUBTYPE, labels[i]);
+  }
+  if (!doc_parts[0] || !doc_parts[1]) {
+    Serial.println("[DocFlash] no doc0/doc1 partitions, keeping documents in RAM");
+    doc_parts[0] = doc_parts[1] = nullptr;
+    return false;
+  }
+  Serial.printf("[DocFlash] 2 slots of %u KB\n", doc_parts[0]->size / 1024);
+  return true;
+}
+
+static bool wcDocFlashReady() { return DOC_FLASH && doc_parts[0] != nullptr; }
+
+// Streams a document into one slot a sector at a time
+class DocFlashWriter {
+public:
+  int      slot    = -1;
+  uint32_t erased  = 0;  // sectors erased and rewritten
+  uint32_t skipped = 0;  // sectors that already held the same bytes
+
+  ~DocFlashWriter() { release(); }
+
+  // False (and slot stays -1) if the sector buffers can't be had
+  bool begin(int s) {
+    _part = doc_parts[s];
+    _buf  = wcDocChunkAlloc();
+    _old  = wcDocChunkAlloc();
+    _pos  = _fill = 0;
+    erased = skipped = 0;
+    if (!_buf || !_old) {
+      release();
+      return false;
+    }
+    slot = s;
+    return true;
+  }
+
+  bool write(const uint8_t *buf, size_t n) {
+    while (n > 0) {
+      size_t take = min(n, (size_t)(DOC_CHUNK - _fill));
+      memcpy(_buf + _fill, buf, take);
+      _fill += take;
+      buf   += take;
+      n     -= take;
+      if (_fill == DOC_CHUNK && !flush()) return false;
+    }
+    return true;
+  }
+
+  // Write out the last partial sector and map the slot into doc.
+  // False if the document didn't fit or flash failed.
+  bool finish(DocStore &doc) {
+    if (!flush()) return false;
+    release();
+    const void *base;
+    spi_flash_mmap_handle_t handle;
+    esp_err_t err = esp_partition_mmap(_part, 0, _pos, SPI_FLASH_MMAP_DATA, &base, &handle);
+    if (err != ESP_OK) {
+      Serial.printf("[DocFlash] mmap failed: %s\n", esp_err_to_name(err));
+      return false;
+    }
+    doc.mapView((const char *)base, _pos, handle);
+    Serial.printf("[DocFlash] slot %d: %d bytes, %u sectors written, %u unchanged\n",
+                  slot, _pos, erased, skipped);
+    return true;
+  }
+
+private:
+  const esp_partition_t *_part = nullptr;
+  char *_buf  = nullptr;   // sector being filled
+  char *_old  = nullptr;   // what the slot holds there now
+  int   _pos  = 0;         // flash offset of _buf
+  int   _fill = 0;
+
+  bool flush() {
+    if (_fill == 0) return true;
+    if (_pos + _fill > (int)_part->size) {
+      Serial.printf("[DocFlash] document larger than slot (%u KB)\n", _part->size / 1024);
+      return false;
+    }
+    if (esp_partition_read(_part, _pos, _old, _fill) == ESP_OK && memcmp(_old, _buf, _fill) == 0) {
+      skipped++;
+    } else {
+      if (esp_partition_erase_range(_part, _pos, DOC_CHUNK) != ESP_OK ||
+          esp_partition_write(_part, _pos, _buf, _fill) != ESP_OK) {
+        Serial.println("[DocFlash] flash write failed");
+        return false;
+      }
+      erased++;
+    }
+    _pos += _fill;
+    _fill = 0;
+    return true;
+  }
+
+  void release() {
+    if (_buf) wcDocChunkFree(_buf);
+    if (_old) wcDocChunkFree(_old);
+    _buf = _old = nullptr;
+  }
+};
@@ -0,0 +1,257 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "LZBlock.h"
+#ifdef ARDUINO
+#include <esp_spi_flash.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Document store: the body kept as a list of fixed-size chunks instead of one
+// contiguous String. A 90 KB file then needs 23 free 4 KB blocks anywhere on
+// the heap rather than a single 90 KB one, so on a fragmented heap the limit
+// is total free memory, not the largest free block. Chunk size is a power of
+// two, so random access is a shift and a mask.
+//
+// A store can also be a read-only view of text that is already in the address
+// space, such as a document mapped from flash (DocFlash.h). Its chunk table
+// then just points into the mapping.
+//
+// Built with DOC_COMPRESS=1, every full chunk is LZ-compressed on its own as
+// soon as the next one starts (see LZBlock.h). Reads then decode a block into
+// one of two 4 KB scratch slots, so drawing a page only decodes the one or
+// two blocks it touches, and a sequential walk decodes each block once.
+// ---------------------------------------------------------------------------
+#ifndef DOC_COMPRESS
+#define DOC_COMPRESS 0
+#endif
+#define DOC_CHUNK_SHIFT 12
+#define DOC_CHUNK       (1 << DOC_CHUNK_SHIFT)  // 4 KB
+#define DOC_POOL_SPARE  2                       // freed chunks kept for the next document
+#define DOC_MIN_SAVING  256                     // compress a chunk only if it saves this much
+
+// Chunk pool. A refresh builds the new document while the old one is still
+// on screen; the chunks the old one gives back are reused by the next fetch
+// instead of going back to the general heap.
+static std::vector<char *> doc_pool;
+
+static char *wcDocChunkAlloc() {
+  if (!doc_pool.empty()) {
+    char *c = doc_pool.back();
+    doc_pool.pop_back();
+    return c;
+  }
+  return (char *)malloc(DOC_CHUNK);
+}
+
+static void wcDocChunkFree(char *c) {
+  if (doc_pool.size() < DOC_POOL_SPARE) doc_pool.push_back(c);
+  else free(c);
+}
+
+class DocStore {
+public:
+  DocStore() {}
+  ~DocStore() { clear(); }
+  DocStore(const DocStore &) = delete;
+  DocStore &operator=(const DocStore &) = delete;
+  DocStore &operator=(DocStore &&o) {
+    if (this != &o) {
+      clear();
+      _chunks.swap(o._chunks);
+      _zlen.swap(o._zlen);
+      for (int s = 0; s < 2; s++) {
+        _slot[s]      = o._slot[s];
+        _slotBlock[s] = o._slotBlock[s];
+        o._slot[s]    = nullptr;
+        o._slotBlock[s] = -1;
+      }
+      _slotLast = o._slotLast;
+      _len      = o._len;
+      _compress = o._compress;
+      _mapped   = o._mapped;
+      _map      = o._map;
+      o._len    = 0;
+      o._mapped = false;
+    }
+    return *this;
+  }
+
+  int  length() const  { return _len; }
+  bool isEmpty() const { return _len == 0; }
+  int  chunks() const  { return _chunks.size(); }
+
+  // Compress chunks as they fill up. Set before the first append.
+  void setCompressed(bool on) { _compress = on; }
+  bool compressed() const     { return _compress; }
+
+  // Heap used by the text itself (compressed size when compressed, 0 when mapped)
+  int heapBytes() const {
+    if (_mapped) return 0;
+    int n = 0;
+    for (size_t b = 0; b < _chunks.size(); b++) n += _zlen[b] ? _zlen[b] : DOC_CHUNK;
+    return n;
+  }
+  uint32_t decodes() const { return _decodes; }  // blocks decompressed so far
+
+  char operator[](int i) const { return block(i >> DOC_CHUNK_SHIFT)[i & (DOC_CHUNK - 1)]; }
+
+  // Longest contiguous run starting at offset i; len is set to its length.
+  // With compression the pointer is valid until two other blocks are read.
+  const char *span(int i, int &len) const {
+    int off = i & (DOC_CHUNK - 1);
+    len = min(DOC_CHUNK - off, _len - i);
+    return block(i >> DOC_CHUNK_SHIFT) + off;
+  }
+
+  // Append bytes, growing by whole chunks. False when out of memory.
+  bool append(const uint8_t *buf, size_t n) {
+    while (n > 0) {
+      int off = _len & (DOC_CHUNK - 1);
+      if (off == 0 && (_len >> DOC_CHUNK_SHIFT) == (int)_chunks.size()) {
+        if (_compress && !_chunks.empty()) sealBlock(_chunks.size() - 1);
+        char *c = wcDocChunkAlloc();
+        if (!c) return false;
+        _chunks.push_back(c);
+        _zlen.push_back(0);
+      }
+      size_t take = min(n, (size_t)(DOC_CHUNK - off));
+      memcpy(_chunks.back() + off, buf, take);
+      _len += take;
+      buf  += take;
+      n    -= take;
+    }
+    return true;
+  }
+
+  // Become a read-only view of len bytes at base, a flash mapping whose
+  // handle is released when the store is cleared
+  void mapView(const char *base, int len, uint32_t handle) {
+    clear();
+    for (int off = 0; off < len; off += DOC_CHUNK) {
+      _chunks.push_back((char *)base + off);
+      _zlen.push_back(0);
+    }
+    _len    = len;
+    _mapped = true;
+    _map    = handle;
+  }
+  bool mapped() const { return _mapped; }
+
+  // Compress the last, partly filled chunk too. No appends after this.
+  void seal() {
+    if (_compress && !_chunks.empty()) sealBlock(_chunks.size() - 1);
+  }
+
+  void clear() {
+    if (_mapped) {
+#ifdef ARDUINO
+      spi_flash_munmap(_map);
+#endif
+      _chunks.clear();
+      _mapped = false;
+    }
+    for (size_t b = 0; b < _chunks.size(); b++) {
+      if (_zlen[b]) free(_chunks[b]);
+      else          wcDocChunkFree(_chunks[b]);
+    }
+    _chunks.clear();
+    _zlen.clear();
+    for (int s = 0; s < 2; s++) {
+      if (_slot[s]) wcDocChunkFree(_slot[s]);
+      _slot[s]      = nullptr;
+      _slotBlock[s] = -1;
+    }
+    _len = 0;
+  }
+
+  // Offset of the first c in [from, to), or -1
+  int indexOf(char c, int from, int to) const {
+    to = min(to, _len);
+    while (from < to) {
+      int n;
+      const char *s = span(from, n);
+      n = min(n, to - from);
+      const char *hit = (const char *)memchr(s, c, n);
+      if (hit) return from + (hit - s);
+      from += n;
+    }
+    return -1;
+  }
+
+  int indexOf(char c, int from) const { return indexOf(c, from, _len); }
+
+  // Copy [from, to) into dst (no terminator)
+  void copy(int from, int to, char *dst) const {
+    while (from < to) {
+      int n;
+      const char *s = span(from, n);
+      n = min(n, to - from);
+      memcpy(dst, s, n);
+      dst  += n;
+      from += n;
+    }
+  }
+
+  String substring(int from, int to) const {
+    String out;
+    out.reserve(to - from);
+    while (from < to) {
+      int n;
+      const char *s = span(from, n);
+      n = min(n, to - from);
+      out.concat(s, n);
+      from += n;
+    }
+    return out;
+  }
+
+private:
+  std::vector<char *>   _chunks;
+  std::vector<uint16_t> _zlen;           // compressed size per chunk, 0 = stored plain
+  int                   _len      = 0;
+  bool                  _compress = DOC_COMPRESS;
+  bool                  _mapped   = false;  // view of a flash mapping, chunks not ours
+  uint32_t              _map      = 0;
+  mutable char         *_slot[2]      = { nullptr, nullptr };  // decoded blocks
+  mutable int           _slotBlock[2] = { -1, -1 };
+  mutable uint8_t       _slotLast     = 0;                     // most recently used slot
+  mutable uint32_t      _decodes      = 0;
+
+  const char *block(int b) const {
+    if (!_zlen[b]) return _chunks[b];
+    if (_slotBlock[_slotLast] == b) return _slot[_slotLast];
+    int s = _slotLast ^ 1;
+    _slotLast = s;
+    if (_slotBlock[s] == b) return _slot[s];
+
+    int len = min(DOC_CHUNK, _len - (b << DOC_CHUNK_SHIFT));
+    if (lzDecompress((const uint8_t *)_chunks[b], _zlen[b], (uint8_t *)_slot[s], DOC_CHUNK) != len) {
+      memset(_slot[s], '?', len);  // can't happen for blocks we compressed ourselves
+    }
+    _slotBlock[s] = b;
+    _decodes++;
+    return _slot[s];
+  }
+
+  // Replace chunk b by its compressed form when that saves enough to matter.
+  // Keeps it plain if compression doesn't pay or memory is short.
+  void sealBlock(int b) {
+    if (_zlen[b]) return;
+    for (int s = 0; s < 2; s++) {
+      if (!_slot[s] && !(_slot[s] = wcDocChunkAlloc())) return;
+    }
+    uint8_t *z = (uint8_t *)_slot[0];  // the decode slots double as compression scratch
+    _slotBlock[0] = -1;
+    int len = min(DOC_CHUNK, _len - (b << DOC_CHUNK_SHIFT));
+    int n   = lzCompress((const uint8_t *)_chunks[b], len, z, len - DOC_MIN_SAVING);
+    if (n <= 0) return;
+    char *packed = (char *)malloc(n);
+    if (!packed) return;
+    memcpy(packed, z, n);
+    wcDocChunkFree(_chunks[b]);
+    _chunks[b] = packed;
+    _zlen[b]   = n;
+  }
+};
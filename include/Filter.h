@@ -0,0 +1,201 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "PagePack.h"
+
+// ---------------------------------------------------------------------------
+// Line filter: a stream stage between the download and the IngestSink that
+// only passes on the lines worth reading. Text it drops never reaches the
+// document store, the hash or the layout, so a 1 MB log can come down to the
+// few KB that match.
+//   include - keep only lines containing one of these substrings
+//   exclude - then drop lines containing any of these
+//   dedupe  - drop a line identical to the last one kept
+//   last N  - keep only the last N lines that survived the above
+// Patterns are comma-separated and case-sensitive. Lines longer than
+// FILTER_LINE_MAX are cut to that length. A page pack (PagePack.h) isn't
+// text: one is recognized by its first 4 bytes, held back until they have
+// all arrived however the body is split, and passed through untouched.
+// ---------------------------------------------------------------------------
+#define FILTER_LINE_MAX 512
+#define FILTER_LAST_MAX 200   // ring of at most 200 x 512 bytes
+
+class LineFilter : public Stream {
+public:
+  // Patterns as typed in the portal; lastN 0 = keep every line
+  void configure(const char *include, const char *exclude, int lastN, bool dedupe) {
+    split(include, _include);
+    split(exclude, _exclude);
+    _lastN  = constrain(lastN, 0, FILTER_LAST_MAX);
+    _dedupe = dedupe;
+  }
+
+  bool active() const { return !_include.empty() || !_exclude.empty() || _lastN || _dedupe; }
+
+  // Start a document; kept lines go to out
+  void begin(Stream &out) {
+    _out  = &out;
+    _len  = 0;
+    _cut  = false;
+    _ok   = true;
+    _prev = 0;
+    _linesIn = _linesKept = 0;
+    _bytesIn = _bytesOut = 0;
+    _raw  = false;
+    _headLen = 0;
+    _decided = false;
+    _ring.assign(_lastN, String());
+    _ringHead = 0;
+  }
+
+  size_t write(const uint8_t *buf, size_t size) override {
+    size_t n = size;
+    if (!_decided) {
+      size_t take = min(size, sizeof(_head) - _headLen);
+      memcpy(_head + _headLen, buf, take);
+      _headLen += take;
+      buf      += take;
+      size     -= take;
+      if (_headLen < sizeof(_head)) return n;
+      decide();
+    }
+    if (size) feed(buf, size);
+    return _ok ? n : 0;  // 0 aborts the transfer
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+
+  int available() override { return 0; }
+  int read() override      { return -1; }
+  int peek() override      { return -1; }
+
+  // Flush the last unterminated line and the last-N ring. False if the
+  // downstream sink ran out of room.
+  bool finish() {
+    if (!_decided) decide();  // a body shorter than the magic
+    if (_raw) {
+      Serial.printf("[Filter] page pack, %u bytes passed through\n", (unsigned)_bytesIn);
+      return _ok;
+    }
+    if (_len || _cut) line();
+    if (_lastN) {
+      int n     = min(_linesKept, (uint32_t)_lastN);
+      int first = _linesKept < (uint32_t)_lastN ? 0 : _ringHead;  // oldest kept line
+      for (int i = 0; i < n && _ok; i++) {
+        const String &s = _ring[(first + i) % _lastN];
+        emit(s.c_str(), s.length());
+      }
+      _ring.clear();
+    }
+    Serial.printf("[Filter] %u of %u lines kept, %u bytes -> %u\n",
+                  (unsigned)(_lastN ? min(_linesKept, (uint32_t)_lastN) : _linesKept),
+                  (unsigned)_linesIn, (unsigned)_bytesIn, (unsigned)_bytesOut);
+    return _ok;
+  }
+
+private:
+  std::vector<String> _include, _exclude;
+  std::vector<String> _ring;       // last N kept lines, oldest at _ringHead
+  int      _ringHead = 0;
+  int      _lastN    = 0;
+  bool     _dedupe   = false;
+  Stream  *_out      = nullptr;
+  char     _line[FILTER_LINE_MAX + 1];
+  int      _len      = 0;
+  bool     _cut      = false;  // current line was longer than the buffer
+  bool     _ok       = true;
+  bool     _raw      = false;  // a page pack: passed through as is
+  uint8_t  _head[4];           // first bytes, held until it's known whether they start a pack
+  size_t   _headLen  = 0;
+  bool     _decided  = false;
+  uint32_t _prev     = 0;      // hash of the last kept line, for dedupe
+  uint32_t _linesIn = 0, _linesKept = 0, _bytesIn = 0, _bytesOut = 0;
+
+  void decide() {
+    _decided = true;
+    _raw     = _headLen == sizeof(_head) && memcmp(_head, PACK_MAGIC, sizeof(_head)) == 0;
+    feed(_head, _headLen);
+  }
+
+  void feed(const uint8_t *buf, size_t size) {
+    _bytesIn += size;
+    if (_raw) {
+      _bytesOut += size;
+      if (_out->write(buf, size) != size) _ok = false;
+      return;
+    }
+    const char *p   = (const char *)buf;
+    const char *end = p + size;
+    while (p < end && _ok) {
+      const char *nl = (const char *)memchr(p, '\n', end - p);
+      const char *e  = nl ? nl : end;
+      int take = min((int)(e - p), FILTER_LINE_MAX - _len);
+      memcpy(_line + _len, p, take);
+      _len += take;
+      if (take < e - p) _cut = true;
+      p = e;
+      if (nl) {
+        line();
+        p++;
+      }
+    }
+  }
+
+  static void split(const char *list, std::vector<String> &out) {
+    out.clear();
+    String s(list);
+    int from = 0;
+    while (from <= (int)s.length()) {
+      int comma = s.indexOf(',', from);
+      if (comma < 0) comma = s.length();
+      String p = s.substring(from, comma);
+      p.trim();
+      if (p.length()) out.push_back(p);
+      from = comma + 1;
+    }
+  }
+
+  static bool matchAny(const char *line, const std::vector<String> &pats) {
+    for (const String &p : pats) {
+      if (strstr(line, p.c_str())) return true;
+    }
+    return false;
+  }
+
+  // FNV-1a; a 32-bit hash is plenty to spot the same line twice in a row
+  static uint32_t hash(const char *s, int n) {
+    uint32_t h = 2166136261u;
+    while (n--) h = (h ^ (uint8_t)*s++) * 16777619u;
+    return h;
+  }
+
+  // One complete line is in _line
+  void line() {
+    if (_len && _line[_len - 1] == '\r') _len--;
+    _line[_len] = '\0';
+    int n = _len;
+    _len = 0;
+    _cut = false;
+    _linesIn++;
+
+    if (!_include.empty() && !matchAny(_line, _include)) return;
+    if (matchAny(_line, _exclude)) return;
+    if (_dedupe) {
+      uint32_t h = hash(_line, n) ^ n;
+      if (_linesKept && h == _prev) return;
+      _prev = h;
+    }
+    _linesKept++;
+    if (_lastN) {
+      _ring[_ringHead] = String(_line);
+      _ringHead = (_ringHead + 1) % _lastN;
+    } else {
+      emit(_line, n);
+    }
+  }
+
+  void emit(const char *s, int n) {
+    if (_out->write((const uint8_t *)s, n) != (size_t)n || _out->write('\n') != 1) _ok = false;
+    _bytesOut += n + 1;
+  }
+};
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Arduino_GFX_Library.h>
+#include "Font.h"
+
+// ---------------------------------------------------------------------------
+// Pre-scaled glyphs for text sizes 2 and 3. Arduino_GFX draws every lit pixel
+// of a scaled character as its own fillRect, i.e. its own address window, so a
+// "Large" page costs thousands of tiny bus transactions. Here the classic 5x7
+// font is expanded at compile time into 1-bit bitmaps of the scaled cell, and
+// a whole text row goes out as one address window streamed a scanline at a
+// time. The font and its expansion are in Font.h.
+// ---------------------------------------------------------------------------
+#define GLYPH_MAX_LINE_PX 320  // longest scanline we stream (panel width)
+
+// Built by the compiler and placed in flash (.rodata), no RAM and no boot cost
+static constexpr ScaledGlyphs<2> GLYPHS_X2{};
+static constexpr ScaledGlyphs<3> GLYPHS_X3{};
+
+static_assert(GLYPHS_X2.bits['A' - GLYPH_FIRST][0] == 0x0C, "glyph expansion");  // top of 'A' = ..##..
+static_assert(sizeof(GLYPHS_X3.bits) == GLYPH_COUNT * 24 * 3, "size 3 cell is 18x24");
+
+static bool wc_glyph_blit = true;  // false = draw through Arduino_GFX (for comparison)
+
+// Stream one glyph scanline into line[] as RGB565
+template <int S>
+static void wcGlyphScanline(const ScaledGlyphs<S> &font, uint8_t c, int y, uint16_t fg, uint16_t bg,
+                            uint16_t *line) {
+  if (c < GLYPH_FIRST || c > GLYPH_LAST) {
+    for (int x = 0; x < font.W; x++) line[x] = bg;  // drawn over afterwards
+    return;
+  }
+  const uint8_t *row = font.bits[c - GLYPH_FIRST] + y * font.ROW;
+  for (int x = 0; x < font.W; x++) line[x] = (row[x >> 3] & (0x80 >> (x & 7))) ? fg : bg;
+}
+
+template <int S>
+static void wcBlitRow(Arduino_TFT *tft, Arduino_DataBus *bus, const ScaledGlyphs<S> &font,
+                      int16_t x, int16_t y, const char *s, const uint16_t *fg, int n, uint16_t bg) {
+  static uint16_t line[GLYPH_MAX_LINE_PX];
+  n = min(n, GLYPH_MAX_LINE_PX / font.W);
+  tft->startWrite();
+  tft->writeAddrWindow(x, y, n * font.W, font.H);
+  for (int r = 0; r < font.H; r++) {
+    for (int i = 0; i < n; i++) wcGlyphScanline(font, (uint8_t)s[i], r, fg[i], bg, line + i * font.W);
+    bus->writePixels(line, n * font.W);
+  }
+  tft->endWrite();
+}
+
+// Draw n chars at (x, y) at text size 2 or 3, each in its own color, as one
+// address window. Bytes outside printable ASCII are left to Arduino_GFX so
+// they look exactly as they did before. Returns false for sizes without a
+// pre-scaled table; the caller then draws the normal way.
+static inline bool wcDrawGlyphRow(Arduino_TFT *tft, Arduino_DataBus *bus, int16_t x, int16_t y,
+                                  const char *s, const uint16_t *fg, int n, int size, uint16_t bg) {
+  if (!wc_glyph_blit || n <= 0) return false;
+  int w;
+  if (size == 2)      { wcBlitRow(tft, bus, GLYPHS_X2, x, y, s, fg, n, bg); w = GLYPHS_X2.W; }
+  else if (size == 3) { wcBlitRow(tft, bus, GLYPHS_X3, x, y, s, fg, n, bg); w = GLYPHS_X3.W; }
+  else return false;
+
+  for (int i = 0; i < n; i++) {
+    uint8_t c = s[i];
+    if (c < GLYPH_FIRST || c > GLYPH_LAST) tft->drawChar(x + i * w, y, c, fg[i], fg[i]);
+  }
+  return true;
+}
+
+// Draw a 1-bit bitmap (MSB first, stride bytes per scanline) w x h at (x, y)
+// in fg on bg, as one address window. Used for pre-rendered page pack rows.
+static inline void wcBlitBits(Arduino_TFT *tft, Arduino_DataBus *bus, int16_t x, int16_t y, const uint8_t *bits,
+                              int stride, int w, int h, uint16_t fg, uint16_t bg) {
+  static uint16_t line[GLYPH_MAX_LINE_PX];
+  w = min(w, min(GLYPH_MAX_LINE_PX, stride * 8));
+  if (w <= 0) return;
+  tft->startWrite();
+  tft->writeAddrWindow(x, y, w, h);
+  for (int r = 0; r < h; r++, bits += stride) {
+    for (int i = 0; i < w; i++) line[i] = (bits[i >> 3] & (0x80 >> (i & 7))) ? fg : bg;
+    bus->writePixels(line, w);
+  }
+  tft->endWrite();
+}
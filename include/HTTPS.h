@@ -2,31 +2,180 @@
 
 #include <FS.h>
 #include <HTTPClient.h>
+#include <StreamString.h>
 #include <WiFiClientSecure.h>
+#include "Trace.h"
+#include "TrustStore.h"
 
-// Fetch a URL over HTTPS and return the full response body as a String.
-// Returns an empty String on any error.
-String https_get_string(const String &url) {
+// Host and port of an https:// URL
+static void https_host_port(const String &url, String &host, uint16_t &port) {
+  int start = url.indexOf("://");
+  start = start < 0 ? 0 : start + 3;
+  int end = start;
+  while (end < (int)url.length() && url[end] != '/' && url[end] != '?') end++;
+  host = url.substring(start, end);
+  port = 443;
+  int colon = host.indexOf(':');
+  if (colon >= 0) {
+    port = host.substring(colon + 1).toInt();
+    host = host.substring(0, colon);
+  }
+}
+
+// WiFiClientSecure that can say which cipher suite was negotiated
+class TlsClient : public WiFiClientSecure {
+public:
+  const char *suite() { return sslclient && connected() ? mbedtls_ssl_get_ciphersuite(&sslclient->ssl_ctx) : "-"; }
+};
+
+// How the last https_fetch() went; tools/fetchbench.py reads these through
+// the console's fetch command
+struct FetchStats {
+  int      code;         // HTTP status, or an HTTPClient error (< 0)
+  int      bytes;        // body bytes received
+  int      size;         // Content-Length, -1 = chunked
+  uint32_t connectMs;    // TCP connect + TLS handshake
+  uint32_t tlsHeap;      // heap held by the open TLS session
+  const char *suite;     // negotiated cipher suite
+  uint32_t firstByteMs;  // from the start to the first body byte
+  uint32_t totalMs;
+  String   etag;         // ETag of the response, for the next If-None-Match
+};
+static FetchStats https_stats;
+
+// Passes the body through to the real sink, noting when the first byte came
+class FirstByteStream : public Stream {
+public:
+  FirstByteStream(Stream &out, uint32_t t0) : _out(out), _t0(t0) {}
+  size_t write(const uint8_t *buf, size_t size) override {
+    if (!https_stats.firstByteMs) https_stats.firstByteMs = max((uint32_t)(millis() - _t0), (uint32_t)1);
+    return _out.write(buf, size);
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+  int available() override { return 0; }
+  int read() override      { return -1; }
+  int peek() override      { return -1; }
+
+private:
+  Stream  &_out;
+  uint32_t _t0;
+};
+
+// Fetch a URL over HTTPS and stream the response body into sink as it
+// arrives (chunked transfer encoding is decoded by HTTPClient). With etag
+// set the request is conditional: a 304 counts as success with no body,
+// check https_stats.code. Returns false on any error, including a body
+// shorter than its Content-Length; sink may then hold a partial body.
+bool https_fetch(const String &url, Stream &sink, const char *etag = nullptr) {
   Serial.printf("[HTTPS] GET %s\n", url.c_str());
-  WiFiClientSecure *client = new WiFiClientSecure;
-  if (!client) return "";
-  client->setInsecure();
-  String body;
-  {
+  uint32_t t0 = millis();
+  https_stats = FetchStats{0, 0, -1, 0, 0, "-", 0, 0, String()};
+  TlsClient *client = new TlsClient;
+  if (!client) return false;
+  client->setCACert(TLS_CA_BUNDLE);
+  client->setHandshakeTimeout(15);  // seconds; the default is two minutes
+  wcTraceBegin(TR_FETCH);
+
+  // Connect up front so the handshake shows up on its own in the trace;
+  // HTTPClient reuses the open connection
+  String   host;
+  uint16_t port;
+  https_host_port(url, host, port);
+  uint32_t heap0 = ESP.getFreeHeap();
+  wcTraceBegin(TR_TLS);
+  bool connected = client->connect(host.c_str(), port);
+  wcTraceEnd(TR_TLS, connected);
+  https_stats.connectMs = millis() - t0;
+  if (connected) {
+    https_stats.tlsHeap = heap0 - min(ESP.getFreeHeap(), heap0);
+    https_stats.suite   = client->suite();
+    Serial.printf("[HTTPS] %s, %lu ms, session %u bytes\n", https_stats.suite,
+                  (unsigned long)https_stats.connectMs, https_stats.tlsHeap);
+  }
+
+  bool ok  = false;
+  int  len = 0;
+  if (connected) {
     HTTPClient https;
     https.begin(*client, url);
     https.setFollowRedirects(HTTPC_STRICT_FOLLOW_REDIRECTS);
     https.addHeader("User-Agent", "esp32-githubraw (github.com/Coreymillia)");
     https.setTimeout(15000);
+    const char *keys[] = { "ETag" };
+    https.collectHeaders(keys, 1);
+    if (etag && *etag) https.addHeader("If-None-Match", etag);
     int code = https.GET();
     Serial.printf("[HTTPS] code: %d\n", code);
+    https_stats.code = code;
     if (code == HTTP_CODE_OK) {
-      body = https.getString();
+      https_stats.size = https.getSize();
+      https_stats.etag = https.header("ETag");
+      FirstByteStream timed(sink, t0);
+      wcTraceBegin(TR_BODY);
+      len = https.writeToStream(&timed);
+      wcTraceEnd(TR_BODY, len);
+      if (len >= 0 && https_stats.size >= 0 && len != https_stats.size) {
+        Serial.printf("[HTTPS] body cut short: %d of %d bytes\n", len, https_stats.size);
+      } else if (len >= 0) {
+        ok = true;
+      } else {
+        https_stats.code = len;
+        Serial.printf("[HTTPS] stream error: %s\n", https.errorToString(len).c_str());
+      }
+    } else if (code == HTTP_CODE_NOT_MODIFIED) {
+      https_stats.etag = etag;
+      ok = true;
     } else {
       Serial.printf("[HTTPS] error: %s\n", https.errorToString(code).c_str());
     }
     https.end();
+  } else {
+    char err[96];
+    client->lastError(err, sizeof(err));  // a failed certificate check says so here
+    Serial.printf("[HTTPS] can't connect to %s:%u: %s\n", host.c_str(), port, err);
+  }
+  delete client;
+  wcTraceEnd(TR_FETCH, ok ? len : 0);
+  https_stats.bytes   = max(len, 0);
+  https_stats.totalMs = millis() - t0;
+  if (https_stats.code == HTTP_CODE_OK) {
+    Serial.printf("[HTTPS] %d bytes, connect %lu ms, first byte %lu ms, total %lu ms (%lu KB/s)\n",
+                  https_stats.bytes, (unsigned long)https_stats.connectMs,
+                  (unsigned long)https_stats.firstByteMs, (unsigned long)https_stats.totalMs,
+                  (unsigned long)(https_stats.bytes / max(https_stats.totalMs, (uint32_t)1)));
   }
+  return ok;
+}
+
+// TLS handshake with the host of url, then close: what https_fetch() pays
+// before the request. verify = false skips the certificate check, for
+// comparing against the old unverified handshake (the self-benchmark);
+// nothing is ever sent over such a connection. Returns the time taken, 0
+// if the handshake failed, and the heap the open session held.
+uint32_t https_handshake(const String &url, bool verify, uint32_t &sessionHeap, const char *&suite) {
+  String   host;
+  uint16_t port;
+  https_host_port(url, host, port);
+  TlsClient *client = new TlsClient;
+  if (!client) return 0;
+  if (verify) client->setCACert(TLS_CA_BUNDLE);
+  else        client->setInsecure();
+  client->setHandshakeTimeout(15);
+  uint32_t heap0 = ESP.getFreeHeap();
+  uint32_t t0    = millis();
+  bool ok = client->connect(host.c_str(), port);
+  uint32_t ms = max((uint32_t)(millis() - t0), (uint32_t)1);
+  sessionHeap = ok ? heap0 - min(ESP.getFreeHeap(), heap0) : 0;
+  suite       = ok ? client->suite() : "-";
+  client->stop();
   delete client;
+  return ok ? ms : 0;
+}
+
+// Fetch a URL over HTTPS and return the full response body as a String.
+// Returns an empty String on any error.
+String https_get_string(const String &url) {
+  StreamString body;
+  if (!https_fetch(url, body)) return "";
   return body;
 }
@@ -0,0 +1,291 @@
+#pragma once
+
+#include <Arduino.h>
+#include <ctype.h>
+
+// ---------------------------------------------------------------------------
+// Syntax highlighting: small table-driven lexers picked by the URL's file
+// extension. The lexer works on any text type with operator[] and is fully
+// resumable: all it carries between calls is one LexState byte, so the page
+// index can checkpoint the state at every page start and drawing any page
+// only has to lex that page.
+// ---------------------------------------------------------------------------
+
+// Color classes (index into Theme::highlight, Theme.h)
+enum LexClass : uint8_t {
+  LEX_PLAIN = 0,
+  LEX_KEYWORD,
+  LEX_STRING,
+  LEX_COMMENT,
+  LEX_NUMBER,
+  LEX_KEY,       // JSON/YAML mapping key
+  LEX_CLASS_COUNT
+};
+
+// Lexer state between tokens
+enum LexState : uint8_t {
+  LEXS_CODE = 0,
+  LEXS_LINE_COMMENT,
+  LEXS_BLOCK_COMMENT,
+  LEXS_STRING_DQ,
+  LEXS_STRING_SQ,
+  LEXS_TRIPLE_DQ,  // Python """ ... """
+  LEXS_TRIPLE_SQ,  // Python ''' ... '''
+  LEXS_STRING_DQ_ESC,  // in a string, right after a backslash that ended the
+  LEXS_STRING_SQ_ESC,  // last call: the next char is escaped
+  LEXS_BLOCK_CLOSE_1,  // in a block comment, the first char of its close ended the last call
+  LEXS_TRIPLE_DQ_1,    // in a triple-quoted string, one or two of its closing
+  LEXS_TRIPLE_DQ_2,    // quotes ended the last call
+  LEXS_TRIPLE_SQ_1,
+  LEXS_TRIPLE_SQ_2,
+};
+
+struct LexRules {
+  const char         *name;
+  const char *const  *keywords;
+  uint8_t             keywordCount;
+  const char         *lineComment;   // nullptr = none
+  const char         *blockOpen;     // nullptr = none
+  const char         *blockClose;    // 2 chars at most (LEXS_BLOCK_CLOSE_1)
+  bool                singleQuotes;  // ' delimits strings
+  bool                tripleQuotes;  // Python docstrings
+  bool                keys;          // word or string followed by ':' is a key
+};
+
+static const char *const LEX_KW_C[] = {
+  "auto", "bool", "break", "case", "catch", "char", "class", "const", "constexpr", "continue",
+  "default", "delete", "do", "double", "else", "enum", "explicit", "extern", "false", "float",
+  "for", "fn", "func", "function", "goto", "if", "import", "inline", "int", "let", "long",
+  "namespace", "new", "nullptr", "operator", "override", "package", "private", "protected",
+  "public", "return", "short", "signed", "sizeof", "static", "struct", "switch", "template",
+  "this", "throw", "true", "try", "typedef", "typename", "uint8_t", "uint16_t", "uint32_t",
+  "union", "unsigned", "using", "var", "virtual", "void", "volatile", "while",
+  "#include", "#define", "#if", "#ifdef", "#ifndef", "#endif", "#else", "#pragma",
+};
+static const char *const LEX_KW_PY[] = {
+  "False", "None", "True", "and", "as", "assert", "async", "await", "break", "class",
+  "continue", "def", "del", "elif", "else", "except", "finally", "for", "from", "global",
+  "if", "import", "in", "is", "lambda", "nonlocal", "not", "or", "pass", "raise", "return",
+  "self", "try", "while", "with", "yield",
+};
+static const char *const LEX_KW_YAML[] = { "true", "false", "null", "yes", "no", "on", "off", "~" };
+static const char *const LEX_KW_JSON[] = { "true", "false", "null" };
+static const char *const LEX_KW_SH[]   = {
+  "case", "do", "done", "echo", "elif", "else", "esac", "exit", "export", "fi", "for",
+  "function", "if", "in", "local", "return", "set", "then", "while",
+};
+
+#define LEX_COUNT(a) (uint8_t)(sizeof(a) / sizeof(a[0]))
+
+static const LexRules LEX_C    = { "c",    LEX_KW_C,    LEX_COUNT(LEX_KW_C),    "//", "/*", "*/", true,  false, false };
+static const LexRules LEX_PY   = { "py",   LEX_KW_PY,   LEX_COUNT(LEX_KW_PY),   "#",  nullptr, nullptr, true, true, false };
+static const LexRules LEX_YAML = { "yaml", LEX_KW_YAML, LEX_COUNT(LEX_KW_YAML), "#",  nullptr, nullptr, true, false, true };
+static const LexRules LEX_JSON = { "json", LEX_KW_JSON, LEX_COUNT(LEX_KW_JSON), nullptr, nullptr, nullptr, false, false, true };
+static const LexRules LEX_SH   = { "sh",   LEX_KW_SH,   LEX_COUNT(LEX_KW_SH),   "#",  nullptr, nullptr, true, false, false };
+
+static const struct { const char *ext; const LexRules *rules; } LEX_BY_EXT[] = {
+  { "c", &LEX_C }, { "h", &LEX_C }, { "cpp", &LEX_C }, { "cc", &LEX_C }, { "hpp", &LEX_C },
+  { "ino", &LEX_C }, { "java", &LEX_C }, { "js", &LEX_C }, { "ts", &LEX_C }, { "go", &LEX_C },
+  { "rs", &LEX_C }, { "cs", &LEX_C }, { "kt", &LEX_C }, { "swift", &LEX_C },
+  { "py", &LEX_PY },
+  { "yml", &LEX_YAML }, { "yaml", &LEX_YAML },
+  { "json", &LEX_JSON },
+  { "sh", &LEX_SH }, { "bash", &LEX_SH },
+};
+
+// Extension of the file a URL names (without the dot, len chars), or nullptr
+static inline const char *wcUrlExt(const char *url, int &len) {
+  const char *end   = url + strcspn(url, "?#");
+  const char *slash = url;
+  for (const char *p = url; p < end; p++) if (*p == '/') slash = p;
+  const char *dot = nullptr;
+  for (const char *p = slash; p < end; p++) if (*p == '.') dot = p + 1;
+  len = dot ? end - dot : 0;
+  return dot;
+}
+
+// Lexer for the URL's file extension, or nullptr for plain text
+static inline const LexRules *wcLexRulesForUrl(const char *url) {
+  int len;
+  const char *dot = wcUrlExt(url, len);
+  if (!dot) return nullptr;
+  for (size_t i = 0; i < sizeof(LEX_BY_EXT) / sizeof(LEX_BY_EXT[0]); i++) {
+    if ((int)strlen(LEX_BY_EXT[i].ext) == len && strncasecmp(dot, LEX_BY_EXT[i].ext, len) == 0) {
+      return LEX_BY_EXT[i].rules;
+    }
+  }
+  return nullptr;
+}
+
+static inline bool wcLexIdentStart(char c) { return isalpha((uint8_t)c) || c == '_' || c == '#'; }
+
+// YAML keys like "runs-on" are one word; in code '-' is an operator
+static inline bool wcLexIdentChar(const LexRules &r, char c) {
+  return isalnum((uint8_t)c) || c == '_' || (c == '-' && r.keys);
+}
+
+template <typename Text>
+static bool wcLexMatch(const Text &t, int pos, int limit, const char *lit) {
+  if (!lit) return false;
+  for (int i = 0; lit[i]; i++) {
+    if (pos + i >= limit || t[pos + i] != lit[i]) return false;
+  }
+  return true;
+}
+
+// After a token ending at pos: is the next non-blank char on the line a ':'?
+template <typename Text>
+static bool wcLexFollowedByColon(const Text &t, int pos, int textLen) {
+  while (pos < textLen && (t[pos] == ' ' || t[pos] == '\t')) pos++;
+  return pos < textLen && t[pos] == ':';
+}
+
+// Lex one token of t starting at pos without reaching past limit. Updates
+// state, sets cls to the token's color class and returns where it ends.
+// A token stopped by limit leaves state mid-construct (e.g. still inside a
+// string), so lexing can resume exactly at any offset.
+template <typename Text>
+static int wcLexToken(const LexRules &r, const Text &t, int pos, int limit, int textLen,
+                      uint8_t &state, uint8_t &cls) {
+  char c = t[pos];
+
+  if (c == '\n') {
+    if (state == LEXS_LINE_COMMENT || state == LEXS_STRING_DQ || state == LEXS_STRING_SQ ||
+        state == LEXS_STRING_DQ_ESC || state == LEXS_STRING_SQ_ESC) state = LEXS_CODE;
+    // a close can't span lines: drop what was seen of one
+    if (state == LEXS_BLOCK_CLOSE_1) state = LEXS_BLOCK_COMMENT;
+    if (state == LEXS_TRIPLE_DQ_1 || state == LEXS_TRIPLE_DQ_2) state = LEXS_TRIPLE_DQ;
+    if (state == LEXS_TRIPLE_SQ_1 || state == LEXS_TRIPLE_SQ_2) state = LEXS_TRIPLE_SQ;
+    cls = state == LEXS_CODE ? LEX_PLAIN : (state == LEXS_BLOCK_COMMENT ? LEX_COMMENT : LEX_STRING);
+    return pos + 1;
+  }
+
+  int p = pos;
+  switch (state) {
+    case LEXS_LINE_COMMENT:
+      while (p < limit && t[p] != '\n') p++;
+      cls = LEX_COMMENT;
+      return p;
+
+    case LEXS_BLOCK_COMMENT:
+    case LEXS_BLOCK_CLOSE_1:
+    case LEXS_TRIPLE_DQ:
+    case LEXS_TRIPLE_DQ_1:
+    case LEXS_TRIPLE_DQ_2:
+    case LEXS_TRIPLE_SQ:
+    case LEXS_TRIPLE_SQ_1:
+    case LEXS_TRIPLE_SQ_2: {
+      // Match the close a char at a time, so one cut by limit carries over
+      // in state as the chars of it seen so far
+      bool block = state == LEXS_BLOCK_COMMENT || state == LEXS_BLOCK_CLOSE_1;
+      bool dq    = state == LEXS_TRIPLE_DQ || state == LEXS_TRIPLE_DQ_1 || state == LEXS_TRIPLE_DQ_2;
+      const char *close = block ? r.blockClose : dq ? "\"\"\"" : "'''";
+      int seen = state == LEXS_BLOCK_CLOSE_1 || state == LEXS_TRIPLE_DQ_1 || state == LEXS_TRIPLE_SQ_1 ? 1
+               : state == LEXS_TRIPLE_DQ_2 || state == LEXS_TRIPLE_SQ_2                             ? 2 : 0;
+      cls = block ? LEX_COMMENT : LEX_STRING;
+      while (p < limit && t[p] != '\n') {
+        if (t[p] == close[seen]) {
+          p++;
+          if (!close[++seen]) { state = LEXS_CODE; return p; }
+        } else if (seen) {
+          seen = 0;  // and look at this char again as the start of a close
+        } else {
+          p++;
+        }
+      }
+      if (block)   state = seen ? LEXS_BLOCK_CLOSE_1 : LEXS_BLOCK_COMMENT;
+      else if (dq) state = seen == 2 ? LEXS_TRIPLE_DQ_2 : seen ? LEXS_TRIPLE_DQ_1 : LEXS_TRIPLE_DQ;
+      else         state = seen == 2 ? LEXS_TRIPLE_SQ_2 : seen ? LEXS_TRIPLE_SQ_1 : LEXS_TRIPLE_SQ;
+      return p;
+    }
+
+    case LEXS_STRING_DQ:
+    case LEXS_STRING_SQ:
+    case LEXS_STRING_DQ_ESC:
+    case LEXS_STRING_SQ_ESC: {
+      bool dq    = state == LEXS_STRING_DQ || state == LEXS_STRING_DQ_ESC;
+      char quote = dq ? '"' : '\'';
+      if (state != (dq ? LEXS_STRING_DQ : LEXS_STRING_SQ)) p++;  // the char escaped at the end of the last call
+      state = dq ? LEXS_STRING_DQ : LEXS_STRING_SQ;
+      while (p < limit && t[p] != '\n') {
+        if (t[p] == '\\') {
+          if (p + 1 == limit) {  // the escaped char is past limit: carry the escape in state
+            state = dq ? LEXS_STRING_DQ_ESC : LEXS_STRING_SQ_ESC;
+            p = limit;
+            break;
+          }
+          p += 2;
+          continue;
+        }
+        if (t[p] == quote) { p++; state = LEXS_CODE; break; }
+        p++;
+      }
+      cls = (state == LEXS_CODE && r.keys && wcLexFollowedByColon(t, p, textLen)) ? LEX_KEY : LEX_STRING;
+      return p;
+    }
+
+    default:
+      break;
+  }
+
+  // LEXS_CODE
+  if (wcLexMatch(t, p, limit, r.lineComment)) {
+    state = LEXS_LINE_COMMENT;
+    return wcLexToken(r, t, pos, limit, textLen, state, cls);
+  }
+  if (wcLexMatch(t, p, limit, r.blockOpen)) {
+    state = LEXS_BLOCK_COMMENT;
+    int open = strlen(r.blockOpen);
+    if (pos + open >= limit) { cls = LEX_COMMENT; return pos + open; }
+    return wcLexToken(r, t, pos + open, limit, textLen, state, cls);
+  }
+  if (r.tripleQuotes && (wcLexMatch(t, p, limit, "\"\"\"") || wcLexMatch(t, p, limit, "'''"))) {
+    state = c == '"' ? LEXS_TRIPLE_DQ : LEXS_TRIPLE_SQ;
+    if (pos + 3 >= limit) { cls = LEX_STRING; return pos + 3; }
+    return wcLexToken(r, t, pos + 3, limit, textLen, state, cls);
+  }
+  if (c == '"' || (c == '\'' && r.singleQuotes)) {
+    state = c == '"' ? LEXS_STRING_DQ : LEXS_STRING_SQ;
+    if (pos + 1 >= limit) { cls = LEX_STRING; return pos + 1; }
+    return wcLexToken(r, t, pos + 1, limit, textLen, state, cls);
+  }
+  if (isdigit((uint8_t)c) || (c == '-' && p + 1 < limit && isdigit((uint8_t)t[p + 1]))) {
+    p++;
+    while (p < limit && (isalnum((uint8_t)t[p]) || t[p] == '.' || t[p] == '_')) p++;
+    cls = LEX_NUMBER;
+    return p;
+  }
+  if (wcLexIdentStart(c)) {
+    p++;
+    while (p < limit && wcLexIdentChar(r, t[p])) p++;
+    cls = LEX_PLAIN;
+    if (r.keys && wcLexFollowedByColon(t, p, textLen)) {
+      cls = LEX_KEY;
+      return p;
+    }
+    int len = p - pos;
+    for (uint8_t k = 0; k < r.keywordCount; k++) {
+      const char *kw = r.keywords[k];
+      if ((int)strlen(kw) == len && wcLexMatch(t, pos, p, kw)) { cls = LEX_KEYWORD; break; }
+    }
+    return p;
+  }
+
+  // Run of whitespace and punctuation up to the next thing worth coloring
+  p++;
+  while (p < limit) {
+    char d = t[p];
+    if (d == '\n' || d == '"' || d == '\'' || isalnum((uint8_t)d) || d == '_' || d == '#') break;
+    if (wcLexMatch(t, p, limit, r.lineComment) || wcLexMatch(t, p, limit, r.blockOpen)) break;
+    p++;
+  }
+  cls = LEX_PLAIN;
+  return p;
+}
+
+// Run the lexer over [from, to) without drawing, carrying state along
+template <typename Text>
+static void wcLexSkip(const LexRules &r, const Text &t, int from, int to, int textLen, uint8_t &state) {
+  uint8_t cls;
+  while (from < to) from = wcLexToken(r, t, from, to, textLen, state, cls);
+}
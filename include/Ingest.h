@@ -0,0 +1,73 @@
+#pragma once
+
+#include <Arduino.h>
+#include <mbedtls/sha256.h>
+#include "DocStore.h"
+#include "DocFlash.h"
+#include "Table.h"
+
+// ---------------------------------------------------------------------------
+// Ingest sink: receives a document body as it streams in from the network,
+// appends it to a chunked DocStore (or streams it into a flash slot, see
+// DocFlash.h) and hashes it on the fly. The ESP32 Arduino core builds mbedtls
+// with the SHA accelerator enabled, so the hash runs in hardware alongside
+// the download and is ready the moment the last byte lands. A TableScan
+// (Table.h) watches the same bytes for CSV/TSV structure.
+// ---------------------------------------------------------------------------
+#define DOC_HASH_LEN 32
+
+class IngestSink : public Stream {
+public:
+  DocStore body;
+  uint8_t  hash[DOC_HASH_LEN];
+  TableScan table;  // detects from the header unless begun again with the URL's separator
+
+  // useFlash = false keeps the document in RAM even when the flash slots are up
+  explicit IngestSink(bool useFlash = true) {
+    mbedtls_sha256_init(&_ctx);
+    mbedtls_sha256_starts(&_ctx, 0);
+    if (useFlash && wcDocFlashReady()) _flash.begin(doc_flash_slot == 0 ? 1 : 0);  // the slot not on screen
+    table.begin(0);
+  }
+  ~IngestSink() { mbedtls_sha256_free(&_ctx); }
+
+  size_t write(const uint8_t *buf, size_t size) override {
+    bool ok = _flash.slot >= 0 ? _flash.write(buf, size) : body.append(buf, size);
+    if (!ok) return 0;  // out of memory or flash slot full: abort the transfer
+    mbedtls_sha256_update(&_ctx, buf, size);
+    table.feed(buf, size);
+    _len += size;
+    return size;
+  }
+  size_t write(uint8_t c) override { return write(&c, 1); }
+
+  // Stream's read side is unused; HTTPClient only writes into us
+  int available() override { return 0; }
+  int read() override      { return -1; }
+  int peek() override      { return -1; }
+
+  int length() const    { return _len; }         // bytes received
+  int flashSlot() const { return _flash.slot; }  // -1 = document is in RAM
+
+  // Call once after the transfer completes; body is readable after this.
+  // False if the document couldn't be put in flash.
+  bool finish() {
+    mbedtls_sha256_finish(&_ctx, hash);
+    table.finish();
+    if (_flash.slot >= 0) return _flash.finish(body);
+    body.seal();
+    return true;
+  }
+
+private:
+  mbedtls_sha256_context _ctx;
+  DocFlashWriter         _flash;
+  int                    _len = 0;
+};
+
+// Short hex prefix of a hash for log lines
+static String wcHashHex(const uint8_t *hash) {
+  char buf[17];
+  for (int i = 0; i < 8; i++) sprintf(buf + i * 2, "%02x", hash[i]);
+  return String(buf);
+}
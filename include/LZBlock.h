@@ -0,0 +1,128 @@
+#pragma once
+
+#include <stdint.h>
+#include <string.h>
+
+// ---------------------------------------------------------------------------
+// Small LZ77 block codec for DocStore chunks (LZ4-style sequences). Every
+// block is compressed on its own, so any one can be decoded without touching
+// the others. Plain C++ with no Arduino dependencies so tools/docbench.cpp can
+// build it on the host.
+//
+// Sequence: token byte (high nibble literal count, low nibble match length
+// minus LZ_MIN_MATCH; 15 = more length bytes follow, each adding up to 255),
+// the literals, then a 2-byte little-endian match offset. The last sequence
+// of a block has literals only.
+// ---------------------------------------------------------------------------
+#define LZ_MIN_MATCH 4
+#define LZ_HASH_BITS 10
+#define LZ_MAX_BLOCK 65535
+
+static inline uint32_t lzRead32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, 4);
+  return v;
+}
+
+static inline uint32_t lzHash(uint32_t v) { return (v * 2654435761u) >> (32 - LZ_HASH_BITS); }
+
+static uint8_t *lzPutLength(uint8_t *op, uint8_t *oend, int len) {
+  while (len >= 255) {
+    if (op >= oend) return nullptr;
+    *op++ = 255;
+    len  -= 255;
+  }
+  if (op >= oend) return nullptr;
+  *op++ = (uint8_t)len;
+  return op;
+}
+
+static uint8_t *lzPutSequence(uint8_t *op, uint8_t *oend, const uint8_t *lit, int litLen,
+                              int matchLen, int offset) {
+  if (op >= oend) return nullptr;
+  uint8_t *token = op++;
+  int ml = matchLen ? matchLen - LZ_MIN_MATCH : 0;
+  *token = (uint8_t)(((litLen < 15 ? litLen : 15) << 4) | (ml < 15 ? ml : 15));
+  if (litLen >= 15 && !(op = lzPutLength(op, oend, litLen - 15))) return nullptr;
+  if (op + litLen > oend) return nullptr;
+  memcpy(op, lit, litLen);
+  op += litLen;
+  if (!matchLen) return op;
+  if (op + 2 > oend) return nullptr;
+  *op++ = offset & 0xFF;
+  *op++ = offset >> 8;
+  if (ml >= 15 && !(op = lzPutLength(op, oend, ml - 15))) return nullptr;
+  return op;
+}
+
+// Compress src into dst (capacity dstCap). Returns the compressed size, or 0
+// when it doesn't fit, in which case the caller keeps the block uncompressed.
+static int lzCompress(const uint8_t *src, int srcLen, uint8_t *dst, int dstCap) {
+  static uint16_t table[1 << LZ_HASH_BITS];  // last position of each 4-byte hash
+  if (srcLen > LZ_MAX_BLOCK) return 0;
+  memset(table, 0xFF, sizeof(table));
+
+  uint8_t       *op     = dst;
+  uint8_t       *oend   = dst + dstCap;
+  const uint8_t *anchor = src;
+  int            ip     = 0;
+
+  while (ip + LZ_MIN_MATCH <= srcLen) {
+    uint32_t h    = lzHash(lzRead32(src + ip));
+    int      cand = table[h];
+    table[h]      = ip;
+    if (cand == 0xFFFF || lzRead32(src + cand) != lzRead32(src + ip)) {
+      ip++;
+      continue;
+    }
+    int len = LZ_MIN_MATCH;
+    while (ip + len < srcLen && src[cand + len] == src[ip + len]) len++;
+    op = lzPutSequence(op, oend, anchor, src + ip - anchor, len, ip - cand);
+    if (!op) return 0;
+    ip    += len;
+    anchor = src + ip;
+  }
+  op = lzPutSequence(op, oend, anchor, src + srcLen - anchor, 0, 0);
+  return op ? op - dst : 0;
+}
+
+static bool lzGetLength(const uint8_t *&ip, const uint8_t *iend, int &len) {
+  uint8_t b;
+  do {
+    if (ip >= iend) return false;
+    b    = *ip++;
+    len += b;
+  } while (b == 255);
+  return true;
+}
+
+// Decompress src into dst (capacity dstCap). Returns the decoded size, or -1
+// on malformed input; never writes past dstCap or reads past srcLen.
+static int lzDecompress(const uint8_t *src, int srcLen, uint8_t *dst, int dstCap) {
+  const uint8_t *ip   = src;
+  const uint8_t *iend = src + srcLen;
+  uint8_t       *op   = dst;
+  uint8_t       *oend = dst + dstCap;
+
+  while (ip < iend) {
+    uint8_t token  = *ip++;
+    int     litLen = token >> 4;
+    if (litLen == 15 && !lzGetLength(ip, iend, litLen)) return -1;
+    if (litLen > iend - ip || litLen > oend - op) return -1;
+    memcpy(op, ip, litLen);
+    op += litLen;
+    ip += litLen;
+    if (ip == iend) break;  // last sequence: literals only
+
+    if (iend - ip < 2) return -1;
+    int offset = ip[0] | (ip[1] << 8);
+    ip += 2;
+    int matchLen = token & 15;
+    if (matchLen == 15 && !lzGetLength(ip, iend, matchLen)) return -1;
+    matchLen += LZ_MIN_MATCH;
+    if (offset == 0 || offset > op - dst || matchLen > oend - op) return -1;
+    const uint8_t *m = op - offset;
+    while (matchLen--) *op++ = *m++;  // byte by byte: the match may overlap its own output
+  }
+  return op - dst;
+}
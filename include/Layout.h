@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Arduino.h>
+
+// ---------------------------------------------------------------------------
+// Text wrapping, independent of the display so host tools run exactly what
+// the firmware runs (tools/layoutfuzz.cpp, tools/pagepack.cpp). Body is
+// anything with length(), operator[] and indexOf(c, from, to): a DocStore
+// on the device.
+//
+// A line is split into rows of at most maxCols chars, at the last space
+// that fits, else hard at maxCols; a wrapped row doesn't start with the
+// spaces it broke at. CR before LF (or at the very end) is dropped, and
+// empty lines take no row.
+//
+// The newline is looked for at most one row ahead, never to the end of the
+// line: a page that breaks inside a long line must not rescan the rest of
+// it, or laying out a document that is one long line goes quadratic. Every
+// row costs O(maxCols) reads and every byte is passed at most twice.
+// ---------------------------------------------------------------------------
+
+#define PANE_PAD 4   // text inset from the pane edge
+
+// Character cell at text size 1-3 (the 6 x 8 font cell, plus 2 px of leading)
+static inline int wcCharW(int size) { return 6 * size; }
+static inline int wcLineH(int size) { return 8 * size + 2; }
+
+// Text rows and columns that fit a pane of w x h pixels at a text size
+static inline int wcLayoutCols(int w, int size) { return max((w - 2 * PANE_PAD) / wcCharW(size), 1); }
+static inline int wcLayoutRows(int h, int size) { return max((h - PANE_PAD) / wcLineH(size), 0); }
+
+// Wrap one page of at most rows rows, starting at offset start. row(from, to, i)
+// is called for the i-th row, covering body[from, to). Returns the offset
+// the following page starts at, or -1 when the body ends on this page.
+template <class Body, class RowFn>
+static int wcWrapPage(const Body &body, int start, int maxCols, int rows, RowFn &&row) {
+  const int len = body.length();
+  int pos  = start;
+  int used = 0;
+
+  while (pos <= len) {
+    // The line end only matters if it is within one row (plus a CR) of pos
+    int limit   = min(len, pos + maxCols + 2);
+    int lineEnd = body.indexOf('\n', pos, limit);
+    if (lineEnd == -1 && limit == len) lineEnd = len;
+    int end = lineEnd;
+    if (end > pos && body[end - 1] == '\r') end--;
+
+    if (lineEnd != -1 && pos >= end) {  // nothing (more) to show on this line
+      pos = lineEnd + 1;
+      continue;
+    }
+    if (used == rows) return pos;
+
+    int cut = end - pos;
+    if (lineEnd == -1 || cut > maxCols) {
+      cut = maxCols;
+      for (int i = maxCols; i > 0; i--) {
+        if (body[pos + i] == ' ') { cut = i; break; }
+      }
+    }
+    row(pos, pos + cut, used++);
+    pos += cut;
+    while (pos < len && body[pos] == ' ') pos++;  // wrapped rows don't start with spaces
+  }
+  return -1;
+}
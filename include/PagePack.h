@@ -0,0 +1,196 @@
+#pragma once
+
+#include <Arduino.h>
+#ifdef ARDUINO
+#include <esp_rom_crc.h>
+#endif
+
+// ---------------------------------------------------------------------------
+// Page packs: a document laid out ahead of time on a PC by tools/pagepack.cpp,
+// which runs the same wrapping code (Layout.h) as the firmware. The device
+// then does no layout at all: the page table is read as is and each page is
+// drawn by looking up its rows. A pack is recognized by its magic whatever
+// it is called or however it arrives (fetch, push, serial).
+//
+// All numbers little endian. Offsets are from the start of the file.
+//
+//    0  "CYDP"
+//    4  u8  version (PACK_VERSION)
+//    5  u8  text size 1-3
+//    6  u8  char width, px      7  u8  line height, px
+//    8  u16 columns per row    10  u16 rows per page
+//   12  u32 pages              16  u32 rows
+//   20  u32 text offset        24  u32 text length      the document, verbatim
+//   28  u32 row table offset   rows x 8: u32 text offset, u16 length,
+//                              u8 color, u8 flags
+//   32  u32 page table offset  pages + 1 x u32: first row of each page, then rows
+//   36  u32 bitmap offset      0 = none; rows x bitmap bytes, 1 bit per
+//                              pixel, MSB first, the row's glyph cells
+//   40  u16 bitmap bytes per row             42  u16 0
+//   44  u32 CRC-32 of the whole file with these four bytes zero
+//
+// Row colors index the theme: 0-5 = text color, PACK_MULTI | n = rainbow
+// color n. A pack only fits a pane with the same text size, columns and
+// rows; anywhere else the firmware lays out the text inside it instead.
+// ---------------------------------------------------------------------------
+#define PACK_MAGIC      "CYDP"
+#define PACK_VERSION    1
+#define PACK_HEADER     48
+#define PACK_CRC_AT     44
+#define PACK_ROW_BYTES  8
+#define PACK_BITS_MAX   1024    // bitmap bytes per row: 312 px x 24 rows at size 3 is 936
+#define PACK_MULTI      0x80    // color byte: rainbow color n = PACK_MULTI | n
+#define PACK_ROW_TEXT   0x01    // row flag: no bitmap (bytes outside the font), draw the text
+
+enum PackStatus : uint8_t { PACK_NONE, PACK_OK, PACK_BAD_VERSION, PACK_BAD_LAYOUT, PACK_BAD_CRC };
+
+struct PackInfo {
+  uint8_t  version = 0, textSize = 0, charW = 0, lineH = 0;
+  uint16_t cols = 0, rows = 0;
+  uint32_t pages = 0, rowCount = 0;
+  uint32_t textOff = 0, textLen = 0, rowOff = 0, pageOff = 0, bitsOff = 0;
+  uint16_t bitsRowBytes = 0;
+  uint32_t crc = 0;
+};
+
+struct PackRow {
+  uint32_t off;    // into the text
+  uint16_t len;
+  uint8_t  color, flags;
+};
+
+static inline uint16_t wcGet16(const uint8_t *p) { return p[0] | p[1] << 8; }
+static inline uint32_t wcGet32(const uint8_t *p) { return p[0] | p[1] << 8 | p[2] << 16 | (uint32_t)p[3] << 24; }
+static inline void wcPut16(uint8_t *p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+static inline void wcPut32(uint8_t *p, uint32_t v) { wcPut16(p, v); wcPut16(p + 2, v >> 16); }
+
+// CRC-32 as zlib computes it; crc is the value so far (0 to start)
+static uint32_t wcCrc32(uint32_t crc, const uint8_t *p, size_t n) {
+#ifdef ARDUINO
+  return esp_rom_crc32_le(crc, p, n);
+#else
+  crc = ~crc;
+  while (n--) {
+    crc ^= *p++;
+    for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+  }
+  return ~crc;
+#endif
+}
+
+static void wcPackEncodeHeader(const PackInfo &h, uint8_t *out) {
+  memset(out, 0, PACK_HEADER);
+  memcpy(out, PACK_MAGIC, 4);
+  out[4] = h.version;
+  out[5] = h.textSize;
+  out[6] = h.charW;
+  out[7] = h.lineH;
+  wcPut16(out + 8, h.cols);
+  wcPut16(out + 10, h.rows);
+  wcPut32(out + 12, h.pages);
+  wcPut32(out + 16, h.rowCount);
+  wcPut32(out + 20, h.textOff);
+  wcPut32(out + 24, h.textLen);
+  wcPut32(out + 28, h.rowOff);
+  wcPut32(out + 32, h.pageOff);
+  wcPut32(out + 36, h.bitsOff);
+  wcPut16(out + 40, h.bitsRowBytes);
+  wcPut32(out + PACK_CRC_AT, h.crc);
+}
+
+static void wcPackDecodeHeader(const uint8_t *in, PackInfo &h) {
+  h.version      = in[4];
+  h.textSize     = in[5];
+  h.charW        = in[6];
+  h.lineH        = in[7];
+  h.cols         = wcGet16(in + 8);
+  h.rows         = wcGet16(in + 10);
+  h.pages        = wcGet32(in + 12);
+  h.rowCount     = wcGet32(in + 16);
+  h.textOff      = wcGet32(in + 20);
+  h.textLen      = wcGet32(in + 24);
+  h.rowOff       = wcGet32(in + 28);
+  h.pageOff      = wcGet32(in + 32);
+  h.bitsOff      = wcGet32(in + 36);
+  h.bitsRowBytes = wcGet16(in + 40);
+  h.crc          = wcGet32(in + PACK_CRC_AT);
+}
+
+// Body is anything with length() and copy(from, to, dst): a DocStore
+template <class Body>
+static bool wcIsPack(const Body &body) {
+  char magic[4];
+  if (body.length() < PACK_HEADER) return false;
+  body.copy(0, 4, magic);
+  return memcmp(magic, PACK_MAGIC, 4) == 0;
+}
+
+template <class Body>
+static PackRow wcPackRow(const Body &body, const PackInfo &h, uint32_t i) {
+  uint8_t e[PACK_ROW_BYTES];
+  body.copy(h.rowOff + i * PACK_ROW_BYTES, h.rowOff + (i + 1) * PACK_ROW_BYTES, (char *)e);
+  return PackRow{ wcGet32(e), wcGet16(e + 4), e[6], e[7] };
+}
+
+// First row of page (page == pages gives the row count)
+template <class Body>
+static uint32_t wcPackPageRow(const Body &body, const PackInfo &h, uint32_t page) {
+  uint8_t e[4];
+  body.copy(h.pageOff + page * 4, h.pageOff + page * 4 + 4, (char *)e);
+  return wcGet32(e);
+}
+
+// Check that body is a pack this firmware can draw without reading outside
+// it: version, checksum, and every table entry in range. PACK_NONE if it
+// isn't a pack at all.
+template <class Body>
+static PackStatus wcPackCheck(const Body &body, PackInfo &h) {
+  if (!wcIsPack(body)) return PACK_NONE;
+  uint8_t buf[256];
+  body.copy(0, PACK_HEADER, (char *)buf);
+  wcPackDecodeHeader(buf, h);
+  if (h.version != PACK_VERSION) return PACK_BAD_VERSION;
+
+  const uint64_t len = body.length();
+  uint32_t crc = wcCrc32(0, buf, PACK_CRC_AT);
+  const uint8_t zero[4] = {};
+  crc = wcCrc32(crc, zero, 4);
+  for (uint32_t at = PACK_HEADER; at < len;) {
+    uint32_t n = min((uint64_t)sizeof(buf), len - at);
+    body.copy(at, at + n, (char *)buf);
+    crc = wcCrc32(crc, buf, n);
+    at += n;
+  }
+  if (crc != h.crc) return PACK_BAD_CRC;
+
+  if (h.textSize < 1 || h.textSize > 3 || !h.cols || !h.rows || !h.pages) return PACK_BAD_LAYOUT;
+  if ((uint64_t)h.textOff + h.textLen > len ||
+      (uint64_t)h.rowOff + (uint64_t)h.rowCount * PACK_ROW_BYTES > len ||
+      (uint64_t)h.pageOff + ((uint64_t)h.pages + 1) * 4 > len) return PACK_BAD_LAYOUT;
+  if (h.bitsOff && (h.bitsRowBytes > PACK_BITS_MAX ||
+                    (uint64_t)h.bitsOff + (uint64_t)h.rowCount * h.bitsRowBytes > len)) return PACK_BAD_LAYOUT;
+  uint32_t prevEnd = 0;
+  for (uint32_t i = 0; i < h.rowCount; i++) {
+    PackRow r = wcPackRow(body, h, i);
+    if (r.off < prevEnd || r.len == 0 || r.len > h.cols || (uint64_t)r.off + r.len > h.textLen)
+      return PACK_BAD_LAYOUT;
+    prevEnd = r.off + r.len;
+  }
+  uint32_t prev = wcPackPageRow(body, h, 0);
+  if (prev != 0 || wcPackPageRow(body, h, h.pages) != h.rowCount) return PACK_BAD_LAYOUT;
+  for (uint32_t pg = 1; pg <= h.pages; pg++) {
+    uint32_t first = wcPackPageRow(body, h, pg);
+    if (first < prev || first - prev > h.rows || (first == prev && pg < h.pages)) return PACK_BAD_LAYOUT;
+    prev = first;
+  }
+  return PACK_OK;
+}
+
+static const char *wcPackError(PackStatus s) {
+  switch (s) {
+    case PACK_BAD_VERSION: return "unsupported version";
+    case PACK_BAD_LAYOUT:  return "inconsistent tables";
+    case PACK_BAD_CRC:     return "checksum mismatch";
+    default:               return "ok";
+  }
+}
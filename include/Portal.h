@@ -4,6 +4,7 @@
 #include <WebServer.h>
 #include <DNSServer.h>
 #include <Preferences.h>
+#include "Theme.h"
 
 // gfx is defined in main.cpp
 extern Arduino_GFX *gfx;
@@ -16,6 +17,18 @@ static char wc_wifi_pass[64]  = "";
 static char wc_raw_url[256]   = "";  // raw.githubusercontent.com URL
 static int  wc_text_color_idx = 0;   // 0=white,1=green,2=cyan,3=yellow,4=orange,5=red,6=rainbow
 static int  wc_text_size      = 1;   // 1=small, 2=medium, 3=large
+static int  wc_power_mode     = 0;   // 0=off, 1=dim backlight, 2=dim + light sleep (Power.h)
+static int  wc_theme_idx      = THEME_DEFAULT;  // 0=dark, 1=light (Theme.h)
+static char wc_push_token[65] = "";  // bearer token for the LAN push endpoint (Push.h), empty = off
+static char wc_filter_include[128] = "";  // line filter (Filter.h): comma-separated patterns
+static char wc_filter_exclude[128] = "";
+static int  wc_filter_last    = 0;   // keep only the last N lines, 0 = all
+static bool wc_filter_dedupe  = false;
+#define WC_EXTRA_PANES 3              // dashboard panes 2-4; pane 1 uses the settings above
+static int  wc_dash_layout    = 0;   // 0=single file, 1-4 = dashboard tilings (Dashboard.h)
+static char wc_dash_url[WC_EXTRA_PANES][256];
+static int  wc_dash_size[WC_EXTRA_PANES]  = { 1, 1, 1 };
+static int  wc_dash_color[WC_EXTRA_PANES] = { 0, 0, 0 };
 static bool wc_has_settings   = false;
 
 // ---------------------------------------------------------------------------
@@ -34,17 +47,38 @@ static void wcLoadSettings() {
   String ssid = prefs.getString("ssid", "");
   String pass = prefs.getString("pass", "");
   String url  = prefs.getString("url",  "");
+  String tok  = prefs.getString("pushtoken", "");
+  String inc  = prefs.getString("flt_incl", "");
+  String exc  = prefs.getString("flt_excl", "");
+  wc_filter_last    = prefs.getInt("flt_last", 0);
+  wc_filter_dedupe  = prefs.getBool("flt_dedupe", false);
+  wc_dash_layout    = prefs.getInt("dash_layout", 0);
+  for (int i = 0; i < WC_EXTRA_PANES; i++) {
+    char key[12];
+    snprintf(key, sizeof(key), "p%durl", i + 2);
+    prefs.getString(key, "").toCharArray(wc_dash_url[i], sizeof(wc_dash_url[i]));
+    snprintf(key, sizeof(key), "p%dsize", i + 2);
+    wc_dash_size[i] = prefs.getInt(key, 1);
+    snprintf(key, sizeof(key), "p%dcolor", i + 2);
+    wc_dash_color[i] = prefs.getInt(key, 0);
+  }
+  wc_text_color_idx = prefs.getInt("coloridx", 0);
+  wc_text_size      = prefs.getInt("textsize",  1);
+  wc_power_mode     = prefs.getInt("power",     0);
+  wc_theme_idx      = prefs.getInt("theme",     THEME_DEFAULT);
   prefs.end();
 
   ssid.toCharArray(wc_wifi_ssid, sizeof(wc_wifi_ssid));
   pass.toCharArray(wc_wifi_pass, sizeof(wc_wifi_pass));
   url.toCharArray(wc_raw_url,   sizeof(wc_raw_url));
-  wc_text_color_idx = prefs.getInt("coloridx", 0);
-  wc_text_size      = prefs.getInt("textsize",  1);
+  tok.toCharArray(wc_push_token, sizeof(wc_push_token));
+  inc.toCharArray(wc_filter_include, sizeof(wc_filter_include));
+  exc.toCharArray(wc_filter_exclude, sizeof(wc_filter_exclude));
   wc_has_settings   = (ssid.length() > 0);
 }
 
-static void wcSaveSettings(const char *ssid, const char *pass, const char *url, int colorIdx, int textSize) {
+static void wcSaveSettings(const char *ssid, const char *pass, const char *url, int colorIdx, int textSize,
+                           int powerMode, const char *pushToken) {
   Preferences prefs;
   prefs.begin("githubraw", false);
   prefs.putString("ssid", ssid);
@@ -52,16 +86,83 @@ static void wcSaveSettings(const char *ssid, const char *pass, const char *url,
   prefs.putString("url",  url);
   prefs.putInt("coloridx", colorIdx);
   prefs.putInt("textsize",  textSize);
+  prefs.putInt("power",     powerMode);
+  prefs.putString("pushtoken", pushToken);
   prefs.end();
 
   strncpy(wc_wifi_ssid, ssid, sizeof(wc_wifi_ssid) - 1);
   strncpy(wc_wifi_pass, pass, sizeof(wc_wifi_pass) - 1);
   strncpy(wc_raw_url,   url,  sizeof(wc_raw_url)   - 1);
+  strncpy(wc_push_token, pushToken, sizeof(wc_push_token) - 1);
   wc_text_color_idx = colorIdx;
   wc_text_size      = textSize;
+  wc_power_mode     = powerMode;
   wc_has_settings   = true;
 }
 
+static void wcSaveFilter(const char *include, const char *exclude, int lastN, bool dedupe) {
+  Preferences prefs;
+  prefs.begin("githubraw", false);
+  prefs.putString("flt_incl", include);
+  prefs.putString("flt_excl", exclude);
+  prefs.putInt("flt_last", lastN);
+  prefs.putBool("flt_dedupe", dedupe);
+  prefs.end();
+
+  strncpy(wc_filter_include, include, sizeof(wc_filter_include) - 1);
+  strncpy(wc_filter_exclude, exclude, sizeof(wc_filter_exclude) - 1);
+  wc_filter_last   = lastN;
+  wc_filter_dedupe = dedupe;
+}
+
+// Pane 0 is the main file; panes 1-3 are the extra dashboard panes
+static void wcSaveDashboard(int layout, const String *urls, const int *sizes, const int *colors) {
+  Preferences prefs;
+  prefs.begin("githubraw", false);
+  prefs.putInt("dash_layout", layout);
+  for (int i = 0; i < WC_EXTRA_PANES; i++) {
+    char key[12];
+    snprintf(key, sizeof(key), "p%durl", i + 2);
+    prefs.putString(key, urls[i]);
+    snprintf(key, sizeof(key), "p%dsize", i + 2);
+    prefs.putInt(key, sizes[i]);
+    snprintf(key, sizeof(key), "p%dcolor", i + 2);
+    prefs.putInt(key, colors[i]);
+    urls[i].toCharArray(wc_dash_url[i], sizeof(wc_dash_url[i]));
+    wc_dash_size[i]  = sizes[i];
+    wc_dash_color[i] = colors[i];
+  }
+  prefs.end();
+  wc_dash_layout = layout;
+}
+
+// Text size of dashboard pane 2-4 (index 0-2), changed by a swipe
+static void wcSavePaneTextSize(int idx, int textSize) {
+  char key[12];
+  snprintf(key, sizeof(key), "p%dsize", idx + 2);
+  Preferences prefs;
+  prefs.begin("githubraw", false);
+  prefs.putInt(key, textSize);
+  prefs.end();
+  wc_dash_size[idx] = textSize;
+}
+
+static void wcSaveTheme(int theme) {
+  Preferences prefs;
+  prefs.begin("githubraw", false);
+  prefs.putInt("theme", theme);
+  prefs.end();
+  wc_theme_idx = theme;
+}
+
+static void wcSaveTextSize(int textSize) {
+  Preferences prefs;
+  prefs.begin("githubraw", false);
+  prefs.putInt("textsize", textSize);
+  prefs.end();
+  wc_text_size = textSize;
+}
+
 // ---------------------------------------------------------------------------
 // On-screen setup instructions (320x240 landscape)
 // ---------------------------------------------------------------------------
@@ -114,6 +215,23 @@ static void wcShowPortalScreen() {
 // ---------------------------------------------------------------------------
 // Web handlers
 // ---------------------------------------------------------------------------
+
+// A setting as an attribute value: a ' or & in a URL must not end or mangle it
+static String wcHtmlEscape(const char *s) {
+  String out;
+  out.reserve(strlen(s) + 16);
+  for (; *s; s++) {
+    switch (*s) {
+      case '&':  out += "&amp;";  break;
+      case '<':  out += "&lt;";   break;
+      case '\'': out += "&#39;";  break;
+      case '"':  out += "&quot;"; break;
+      default:   out += *s;
+    }
+  }
+  return out;
+}
+
 static void wcHandleRoot() {
   String html = "<!DOCTYPE html><html><head>"
     "<meta charset='UTF-8'>"
@@ -144,21 +262,21 @@ static void wcHandleRoot() {
     "<form method='post' action='/save'>"
     "<label>WiFi Network Name (SSID):</label>"
     "<input type='text' name='ssid' value='";
-  html += String(wc_wifi_ssid);
+  html += wcHtmlEscape(wc_wifi_ssid);
   html += "' placeholder='Your 2.4 GHz WiFi name' maxlength='63' required>"
     "<label>WiFi Password:</label>"
     "<input type='password' name='pass' value='";
-  html += String(wc_wifi_pass);
+  html += wcHtmlEscape(wc_wifi_pass);
   html += "' placeholder='Leave blank if open network' maxlength='63'>"
     "<label>Raw GitHub URL:</label>"
     "<input type='url' name='url' value='";
-  html += String(wc_raw_url);
+  html += wcHtmlEscape(wc_raw_url);
   html += "' placeholder='https://raw.githubusercontent.com/user/repo/main/file.txt'"
     " maxlength='255' required>";
 
   // Text color dropdown
   html += "<label>Text Color:</label><select name='color'>";
-  const char* colorNames[] = {"White", "Green", "Cyan", "Yellow", "Orange", "Red", "&#127752; Rainbow (multi-color)"};
+  const char* colorNames[] = {THEMES[constrain(wc_theme_idx, 0, THEME_COUNT - 1)].inkName, "Green", "Cyan", "Yellow", "Orange", "Red", "&#127752; Rainbow (multi-color)"};
   for (int i = 0; i <= 6; i++) {
     html += "<option value='" + String(i) + "'";
     if (wc_text_color_idx == i) html += " selected";
@@ -180,6 +298,84 @@ static void wcHandleRoot() {
   }
   html += "</select>";
 
+  // Background; white runs the panel inverted
+  html += "<label>Background:</label><select name='theme'>";
+  html += wc_theme_idx == THEME_LIGHT ? "<option value='0'>Black</option><option value='1' selected>White</option>"
+                                      : "<option value='0' selected>Black</option><option value='1'>White</option>";
+  html += "</select>";
+
+  // Power saving dropdown
+  html += "<label>Power Saving:</label><select name='power'>";
+  const char* powerNames[] = {"Off (default)", "Dim screen when idle", "Dim + sleep between updates (battery)"};
+  for (int i = 0; i <= 2; i++) {
+    html += "<option value='" + String(i) + "'";
+    if (wc_power_mode == i) html += " selected";
+    html += ">";
+    html += powerNames[i];
+    html += "</option>";
+  }
+  html += "</select>";
+
+  // Dashboard: tile the screen with up to four feeds
+  html += "<hr><p>Dashboard (optional): show several files at once. The file above is pane 1.</p>"
+    "<label>Layout:</label><select name='dash'>";
+  const char* layoutNames[] = {"Single file (default)", "2 panes side by side", "2 panes stacked",
+                               "3 panes: 1 on top, 2 below", "4 panes: 2 x 2 grid"};
+  for (int i = 0; i <= 4; i++) {
+    html += "<option value='" + String(i) + "'";
+    if (wc_dash_layout == i) html += " selected";
+    html += ">";
+    html += layoutNames[i];
+    html += "</option>";
+  }
+  html += "</select>";
+  for (int p = 0; p < WC_EXTRA_PANES; p++) {
+    String n = String(p + 2);
+    html += "<label>Pane " + n + " URL:</label><input type='url' name='p" + n + "url' value='";
+    html += wcHtmlEscape(wc_dash_url[p]);
+    html += "' placeholder='Only used when the layout has " + n + " panes' maxlength='255'>";
+    html += "<label>Pane " + n + " Text Size / Color:</label><select name='p" + n + "size'>";
+    for (int i = 1; i <= 3; i++) {
+      html += "<option value='" + String(i) + "'";
+      if (wc_dash_size[p] == i) html += " selected";
+      html += ">";
+      html += sizeNames[i];
+      html += "</option>";
+    }
+    html += "</select><select name='p" + n + "color'>";
+    for (int i = 0; i <= 6; i++) {
+      html += "<option value='" + String(i) + "'";
+      if (wc_dash_color[p] == i) html += " selected";
+      html += ">";
+      html += colorNames[i];
+      html += "</option>";
+    }
+    html += "</select>";
+  }
+
+  html += "<hr><label>LAN Push Token (optional):</label>"
+    "<input type='text' name='pushtoken' value='";
+  html += wcHtmlEscape(wc_push_token);
+  html += "' placeholder='Leave blank to disable push' maxlength='64'>";
+
+  // Line filter, for big log files
+  html += "<hr><p>Line filter (optional, for large logs). Patterns are comma-separated and case-sensitive.</p>"
+    "<label>Show only lines containing:</label>"
+    "<input type='text' name='finc' value='";
+  html += wcHtmlEscape(wc_filter_include);
+  html += "' placeholder='e.g. ERROR,FAIL' maxlength='127'>"
+    "<label>Hide lines containing:</label>"
+    "<input type='text' name='fexc' value='";
+  html += wcHtmlEscape(wc_filter_exclude);
+  html += "' placeholder='e.g. healthcheck' maxlength='127'>"
+    "<label>Keep only the last N lines (0 = all, max 200):</label>"
+    "<input type='number' name='flast' min='0' max='200' value='";
+  html += String(wc_filter_last);
+  html += "'><label>Repeated lines:</label><select name='fdedupe'>";
+  html += wc_filter_dedupe ? "<option value='0'>Show all</option><option value='1' selected>Show once</option>"
+                           : "<option value='0' selected>Show all</option><option value='1'>Show once</option>";
+  html += "</select>";
+
   html += "<br><button class='btn btn-save' type='submit'>&#128190; Save &amp; Connect</button>"
     "</form>";
   if (wc_has_settings) {
@@ -211,7 +407,22 @@ static void wcHandleSave() {
 
   wcSaveSettings(ssid.c_str(), pass.c_str(), url.c_str(),
     portalServer->hasArg("color") ? constrain(portalServer->arg("color").toInt(), 0, 6) : 0,
-    portalServer->hasArg("size")  ? constrain(portalServer->arg("size").toInt(),  1, 3) : 1);
+    portalServer->hasArg("size")  ? constrain(portalServer->arg("size").toInt(),  1, 3) : 1,
+    portalServer->hasArg("power") ? constrain(portalServer->arg("power").toInt(), 0, 2) : 0,
+    portalServer->hasArg("pushtoken") ? portalServer->arg("pushtoken").c_str() : "");
+  wcSaveTheme(portalServer->hasArg("theme") ? constrain((int)portalServer->arg("theme").toInt(), 0, THEME_COUNT - 1)
+                                             : THEME_DEFAULT);
+  String dashUrl[WC_EXTRA_PANES];
+  int    dashSize[WC_EXTRA_PANES], dashColor[WC_EXTRA_PANES];
+  for (int p = 0; p < WC_EXTRA_PANES; p++) {
+    String n = String(p + 2);
+    dashUrl[p]   = portalServer->arg("p" + n + "url");
+    dashSize[p]  = constrain((int)portalServer->arg("p" + n + "size").toInt(), 1, 3);
+    dashColor[p] = constrain((int)portalServer->arg("p" + n + "color").toInt(), 0, 6);
+  }
+  wcSaveDashboard(constrain((int)portalServer->arg("dash").toInt(), 0, 4), dashUrl, dashSize, dashColor);
+  wcSaveFilter(portalServer->arg("finc").c_str(), portalServer->arg("fexc").c_str(),
+    constrain(portalServer->arg("flast").toInt(), 0, 200), portalServer->arg("fdedupe") == "1");
 
   String html = "<html><head><meta charset='UTF-8'>"
     "<style>body{background:#001a33;color:#00ccff;font-family:Arial;"
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+#include <driver/ledc.h>
+#include <driver/uart.h>
+#include "Trace.h"
+
+// ---------------------------------------------------------------------------
+// Power manager, mode chosen by wc_power_mode (Portal.h)
+//   POWER_OFF   - always awake, backlight full (the original behaviour)
+//   POWER_DIM   - always awake, backlight dims and then switches off when idle
+//   POWER_SLEEP - as POWER_DIM, plus light sleep between events. Wakes on the
+//                 XPT2046 IRQ, the BOOT button, serial input (the first few
+//                 characters are lost; send an empty line first) or the next
+//                 refresh/clock timer.
+// ---------------------------------------------------------------------------
+#define POWER_OFF   0
+#define POWER_DIM   1
+#define POWER_SLEEP 2
+
+#define BL_DUTY_FULL      255
+#define BL_DUTY_DIM       24
+#define BL_DIM_MS         (60UL * 1000UL)        // dim after a minute without input
+#define BL_OFF_MS         (10UL * 60UL * 1000UL) // dark after ten
+#define POWER_MIN_SLEEP_MS 20                    // not worth sleeping for less
+#define POWER_WAKE_BUDGET_US 120000              // wake -> first frame on screen
+#define POWER_REPORT_MS   (60UL * 60UL * 1000UL)
+
+// Rough CYD supply currents in mA, used for the hourly estimate
+#define POWER_MA_AWAKE    80.0f   // CPU at 240 MHz + WiFi in modem sleep
+#define POWER_MA_SLEEP    2.5f    // light sleep incl. regulator and USB-UART quiescent
+#define POWER_MA_BL_FULL  45.0f   // backlight at 100 % duty
+
+static uint8_t  pwr_irq_pin, pwr_boot_pin;
+static uint32_t pwr_bl_duty    = BL_DUTY_FULL;
+static uint32_t pwr_last_input = 0;      // millis() of the last touch/button
+static bool     pwr_wake_pending = false;
+static uint32_t pwr_wake_us    = 0;      // micros() when we came out of light sleep
+static uint32_t pwr_wake_lat_max = 0;
+static uint32_t pwr_wake_over  = 0;      // frames that missed POWER_WAKE_BUDGET_US
+
+// Time accounting since the last report
+static uint64_t pwr_awake_us   = 0;
+static uint64_t pwr_sleep_us   = 0;
+static double   pwr_bl_mAus    = 0;      // backlight charge in mA*us
+static uint32_t pwr_mark_us    = 0;      // start of the interval not yet accounted
+static uint32_t pwr_report_ms  = 0;
+static uint32_t pwr_wakes_timer = 0, pwr_wakes_gpio = 0;
+
+static void wcPowerAccount(bool asleep) {
+  uint32_t now = micros();
+  uint32_t dt  = now - pwr_mark_us;
+  pwr_mark_us  = now;
+  if (asleep) pwr_sleep_us += dt;
+  else        pwr_awake_us += dt;
+  pwr_bl_mAus += POWER_MA_BL_FULL * pwr_bl_duty / 255.0f * dt;
+}
+
+static void wcSetBacklight(uint32_t duty) {
+  if (duty == pwr_bl_duty) return;
+  wcPowerAccount(false);
+  pwr_bl_duty = duty;
+  ledc_set_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0, duty);
+  ledc_update_duty(LEDC_LOW_SPEED_MODE, LEDC_CHANNEL_0);
+}
+
+// The backlight runs from the RTC 8 MHz clock so its PWM keeps going while
+// the CPU and APB clock are stopped in light sleep.
+static void wcPowerBegin(uint8_t blPin, uint8_t irqPin, uint8_t bootPin) {
+  pwr_irq_pin  = irqPin;
+  pwr_boot_pin = bootPin;
+
+  ledc_timer_config_t timer = {};
+  timer.speed_mode      = LEDC_LOW_SPEED_MODE;
+  timer.duty_resolution = LEDC_TIMER_8_BIT;
+  timer.timer_num       = LEDC_TIMER_0;
+  timer.freq_hz         = 1000;
+  timer.clk_cfg         = LEDC_USE_RTC8M_CLK;
+  ledc_timer_config(&timer);
+
+  ledc_channel_config_t ch = {};
+  ch.gpio_num   = blPin;
+  ch.speed_mode = LEDC_LOW_SPEED_MODE;
+  ch.channel    = LEDC_CHANNEL_0;
+  ch.timer_sel  = LEDC_TIMER_0;
+  ch.duty       = BL_DUTY_FULL;
+  ch.hpoint     = 0;
+  ledc_channel_config(&ch);
+  esp_sleep_pd_config(ESP_PD_DOMAIN_RTC8M, ESP_PD_OPTION_ON);
+
+  pwr_bl_duty    = BL_DUTY_FULL;
+  pwr_last_input = millis();
+  pwr_report_ms  = millis();
+  pwr_mark_us    = micros();
+}
+
+// Call when a frame has finished drawing; closes the wake-latency measurement
+static void wcPowerFrameDrawn() {
+  if (!pwr_wake_pending) return;
+  pwr_wake_pending = false;
+  uint32_t lat = micros() - pwr_wake_us;
+  if (lat > pwr_wake_lat_max) pwr_wake_lat_max = lat;
+  if (lat > POWER_WAKE_BUDGET_US) pwr_wake_over++;
+  Serial.printf("[Power] wake->draw %lu us (budget %lu, max %lu, over %lu)\n",
+                (unsigned long)lat, (unsigned long)POWER_WAKE_BUDGET_US,
+                (unsigned long)pwr_wake_lat_max, (unsigned long)pwr_wake_over);
+}
+
+// Note user input. Returns true when the screen was dark, in which case the
+// input only wakes the display and shouldn't also act on the page.
+static bool wcPowerActivity() {
+  bool wasDark = pwr_bl_duty == 0;
+  pwr_last_input = millis();
+  wcSetBacklight(BL_DUTY_FULL);
+  if (wasDark) wcPowerFrameDrawn();  // the panel kept its image; lighting it is the first frame
+  return wasDark;
+}
+
+static void wcPowerReport() {
+  wcPowerAccount(false);
+  double secs  = (pwr_awake_us + pwr_sleep_us) / 1e6;
+  if (secs <= 0) return;
+  double mAs   = (POWER_MA_AWAKE * pwr_awake_us + POWER_MA_SLEEP * pwr_sleep_us + pwr_bl_mAus) / 1e6;
+  double avgMA = mAs / secs;
+  Serial.printf("[Power] %.0f s: awake %.1f s, asleep %.1f s (%lu timer / %lu input wakes), "
+                "est. %.1f mA avg (mAh per hour)\n",
+                secs, pwr_awake_us / 1e6, pwr_sleep_us / 1e6,
+                (unsigned long)pwr_wakes_timer, (unsigned long)pwr_wakes_gpio, avgMA);
+  pwr_awake_us = pwr_sleep_us = 0;
+  pwr_bl_mAus  = 0;
+  pwr_wakes_timer = pwr_wakes_gpio = 0;
+}
+
+// Idle until the next event, at most maxMs. Depending on the mode this is a
+// plain delay or a light sleep that the touch IRQ or BOOT button cut short.
+static void wcPowerIdle(uint32_t maxMs) {
+  uint32_t now = millis();
+
+  if (wc_power_mode >= POWER_DIM) {
+    uint32_t idle = now - pwr_last_input;
+    if (idle >= BL_OFF_MS)      wcSetBacklight(0);
+    else if (idle >= BL_DIM_MS) wcSetBacklight(BL_DUTY_DIM);
+    // wake again in time for the next backlight step
+    if (idle < BL_DIM_MS)      maxMs = min(maxMs, (uint32_t)(BL_DIM_MS - idle));
+    else if (idle < BL_OFF_MS) maxMs = min(maxMs, (uint32_t)(BL_OFF_MS - idle));
+  }
+  if (now - pwr_report_ms >= POWER_REPORT_MS) {
+    pwr_report_ms = now;
+    wcPowerReport();
+  }
+
+  bool inputActive = digitalRead(pwr_irq_pin) == LOW || digitalRead(pwr_boot_pin) == LOW;
+  if (wc_power_mode < POWER_SLEEP || maxMs < POWER_MIN_SLEEP_MS || inputActive) {
+    delay(min(maxMs, (uint32_t)50));
+    return;
+  }
+
+  Serial.flush();  // the UART stops mid-character otherwise
+  wcPowerAccount(false);
+  esp_sleep_enable_timer_wakeup((uint64_t)maxMs * 1000ULL);
+  gpio_wakeup_enable((gpio_num_t)pwr_irq_pin,  GPIO_INTR_LOW_LEVEL);
+  gpio_wakeup_enable((gpio_num_t)pwr_boot_pin, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  uart_set_wakeup_threshold(UART_NUM_0, 3);  // console commands
+  esp_sleep_enable_uart_wakeup(0);
+  pwr_wake_pending = false;  // the last wake never led to a draw
+
+  wcTraceBegin(TR_SLEEP);
+  esp_light_sleep_start();
+  wcTraceEnd(TR_SLEEP, esp_sleep_get_wakeup_cause());
+
+  wcPowerAccount(true);
+  gpio_wakeup_disable((gpio_num_t)pwr_irq_pin);
+  gpio_wakeup_disable((gpio_num_t)pwr_boot_pin);
+  gpio_set_intr_type((gpio_num_t)pwr_irq_pin, GPIO_INTR_NEGEDGE);  // XPT2046 library's IRQ edge
+
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+    pwr_wakes_gpio++;
+    pwr_wake_pending = true;
+    pwr_wake_us      = micros();
+  } else {
+    pwr_wakes_timer++;
+  }
+}
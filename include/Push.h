@@ -0,0 +1,162 @@
+#pragma once
+
+#include <Arduino.h>
+#include <WiFi.h>
+#include <WebServer.h>
+#include "Portal.h"
+#include "Ingest.h"
+#include "Trace.h"
+
+// ---------------------------------------------------------------------------
+// LAN push: a small HTTP server in STA mode so a machine on the same network
+// can put text on screen now instead of waiting for the next poll.
+//
+//   POST /text      body = the document; shown as soon as the last byte lands
+//   POST /text?refetch=1   same, then fetch the GitHub file right away
+//   POST /refetch   just fetch the GitHub file now
+//   GET  /screen    what the panel shows, RLE (Screenshot.h; tools/rle2png.py)
+//   GET  /bench     run the self-benchmark, results as text (Bench.h)
+//
+// The GET routes are the firmware's (PushRoute table passed to wcPushBegin).
+//
+// Every request needs "Authorization: Bearer <token>", the push token from
+// the setup portal; with no token set the server isn't started. The body is
+// streamed straight into an IngestSink, so it takes the same path as a
+// download (chunked DocStore or flash slot, hash, unchanged check) and is
+// never held in one piece. A pushed document stays up until the next poll
+// brings a different file.
+//
+//   curl -H "Authorization: Bearer $TOKEN" --data-binary @status.txt http://<ip>/text
+// ---------------------------------------------------------------------------
+#define PUSH_PORT 80
+
+// Puts a finished sink on screen; false if it matched what is already shown
+typedef bool (*PushShowFn)(IngestSink &sink, const char *tag);
+// Answers a GET route; the token has already been checked
+struct PushRoute {
+  const char *path;
+  void (*fn)(WebServer &server);
+};
+
+static WebServer  *push_server  = nullptr;
+static PushShowFn  push_show    = nullptr;
+static IngestSink *push_sink    = nullptr;
+static bool        push_authed  = false;
+static bool        push_overrun = false;  // the body didn't fit
+static uint32_t    push_t0      = 0;      // micros() when the body started arriving
+static bool        push_refetch = false;  // set here, consumed by loop()
+
+// Compare the whole header whatever the input, so timing doesn't leak the token
+static bool wcPushAuthorized() {
+  String got    = push_server->header("Authorization");
+  String expect = String("Bearer ") + wc_push_token;
+  uint8_t diff  = got.length() != expect.length();
+  for (unsigned i = 0; i < expect.length(); i++) diff |= expect[i] ^ (i < got.length() ? got[i] : 0);
+  return diff == 0;
+}
+
+static void wcPushDrop() {
+  delete push_sink;
+  push_sink = nullptr;
+}
+
+// Body chunks as they come off the socket
+static void wcPushRaw() {
+  HTTPRaw &raw = push_server->raw();
+  switch (raw.status) {
+    case RAW_START:
+      push_t0      = micros();
+      push_authed  = wcPushAuthorized();
+      push_overrun = false;
+      wcPushDrop();
+      if (!push_authed) break;
+      push_sink = new IngestSink;
+      wcTraceBegin(TR_PUSH);
+      break;
+    case RAW_WRITE:
+      if (push_sink && push_sink->write(raw.buf, raw.currentSize) != raw.currentSize) {
+        push_overrun = true;
+        wcPushDrop();
+      }
+      break;
+    case RAW_ABORTED:
+      if (!push_authed) break;
+      Serial.println("[Push] client went away mid-body");
+      wcPushDrop();
+      wcTraceEnd(TR_PUSH, 0);
+      break;
+    default:
+      break;
+  }
+}
+
+// Runs once the whole request is in
+static void wcPushText() {
+  if (!wcPushAuthorized()) {
+    wcPushDrop();
+    push_server->send(401, "text/plain", "bad or missing token\n");
+    return;
+  }
+  if (push_overrun || !push_sink || push_sink->length() == 0 || !push_sink->finish()) {
+    bool big = push_overrun;
+    wcPushDrop();
+    wcTraceEnd(TR_PUSH, 0);
+    push_server->send(big ? 413 : 400, "text/plain", big ? "document too large\n" : "empty body\n");
+    return;
+  }
+
+  int  bytes   = push_sink->length();
+  bool changed = push_show(*push_sink, "Push");
+  wcPushDrop();
+  uint32_t us = micros() - push_t0;
+  wcTraceEnd(TR_PUSH, changed ? 2 : 1);
+  if (push_server->arg("refetch") == "1") push_refetch = true;
+
+  Serial.printf("[Push] %d bytes from %s, %s, push->pixels %lu us\n", bytes,
+                push_server->client().remoteIP().toString().c_str(),
+                changed ? "shown" : "unchanged", (unsigned long)us);
+  char json[96];
+  snprintf(json, sizeof(json), "{\"bytes\":%d,\"changed\":%s,\"push_to_pixels_us\":%lu}\n",
+           bytes, changed ? "true" : "false", (unsigned long)us);
+  push_server->send(200, "application/json", json);
+}
+
+static void wcPushRefetch() {
+  if (!wcPushAuthorized()) {
+    push_server->send(401, "text/plain", "bad or missing token\n");
+    return;
+  }
+  push_refetch = true;
+  push_server->send(202, "text/plain", "refetch queued\n");
+}
+
+// Call once WiFi is up. Does nothing without a push token.
+static bool wcPushBegin(PushShowFn show, const PushRoute *gets, int getCount) {
+  if (!wc_push_token[0]) return false;
+  static const char *headers[] = { "Content-Type" };  // Authorization is always collected
+  push_show   = show;
+  push_server = new WebServer(PUSH_PORT);
+  push_server->collectHeaders(headers, 1);
+  push_server->on("/text", HTTP_POST, wcPushText, wcPushRaw);
+  push_server->on("/refetch", HTTP_POST, wcPushRefetch);
+  for (int i = 0; i < getCount; i++) {
+    auto fn = gets[i].fn;
+    push_server->on(gets[i].path, HTTP_GET, [fn]() {
+      if (wcPushAuthorized()) fn(*push_server);
+      else push_server->send(401, "text/plain", "bad or missing token\n");
+    });
+  }
+  push_server->onNotFound([]() { push_server->send(404, "text/plain", "POST /text or /refetch, GET /screen or /bench\n"); });
+  push_server->begin();
+  Serial.printf("[Push] listening on http://%s:%d/text\n", WiFi.localIP().toString().c_str(), PUSH_PORT);
+  return true;
+}
+
+// Call from loop(). True when a client asked for an immediate refetch.
+static bool wcPushPoll() {
+  if (!push_server) return false;
+  push_server->handleClient();
+  bool r = push_refetch;
+  push_refetch = false;
+  return r;
+}
@@ -0,0 +1,107 @@
+#pragma once
+
+#include <Arduino.h>
+#include <Arduino_GFX_Library.h>
+#include "Glyphs.h"
+#include "Highlight.h"
+#include "Layout.h"
+#include "Theme.h"
+
+// ---------------------------------------------------------------------------
+// Drawing a page of text: the panel comes in as arguments, so host tools
+// render with the firmware's own code into a framebuffer (tools/host,
+// tools/rendertest.cpp). Page is anything with the text fields of a Pane
+// (Dashboard.h): x, y, w, h, textSize, colorIdx, lexRules and body.
+// ---------------------------------------------------------------------------
+
+// Draw body[from, to) at the cursor one token at a time in its highlight color.
+// lex carries the lexer state in and out.
+template <class Page>
+static void wcDrawHighlighted(Arduino_TFT *tft, const Page &p, int from, int to, uint16_t plainColor,
+                              uint8_t &lex) {
+  int bodyLen = p.body.length();
+  while (from < to) {
+    uint8_t cls;
+    int e = wcLexToken(*p.lexRules, p.body, from, to, bodyLen, lex, cls);
+    tft->setTextColor(cls == LEX_PLAIN ? plainColor : wc_theme->highlight[cls]);
+    tft->print(p.body.substring(from, e));
+    from = e;
+  }
+}
+
+// Draw body[from, to) as one text row at (x, y) in color, or with lex set in
+// syntax highlight colors (lex carries the lexer state in and out). Sizes 2
+// and 3 go out as a single pre-scaled bitmap, size 1 through Arduino_GFX.
+template <class Page>
+static void wcDrawRow(Arduino_TFT *tft, Arduino_DataBus *bus, const Page &p, int from, int to, int x, int y,
+                      uint16_t color, uint8_t *lex) {
+  static uint16_t colors[GLYPH_MAX_LINE_PX / GLYPHS_X2.W];
+  int sz = constrain(p.textSize, 1, 3);
+  int n  = to - from;
+
+  if (sz >= 2 && wc_glyph_blit && n <= (int)(sizeof(colors) / sizeof(colors[0]))) {
+    int bodyLen = p.body.length();
+    for (int i = from; i < to;) {
+      uint8_t cls = LEX_PLAIN;
+      int     e   = lex ? wcLexToken(*p.lexRules, p.body, i, to, bodyLen, *lex, cls) : to;
+      uint16_t c  = cls == LEX_PLAIN ? color : wc_theme->highlight[cls];
+      for (; i < e; i++) colors[i - from] = c;
+    }
+    char text[sizeof(colors) / sizeof(colors[0])];  // the row may straddle two chunks
+    p.body.copy(from, to, text);
+    wcDrawGlyphRow(tft, bus, x, y, text, colors, n, sz, RGB565_BLACK);
+    return;
+  }
+
+  tft->setCursor(x, y);
+  if (lex) {
+    wcDrawHighlighted(tft, p, from, to, color, *lex);
+  } else {
+    tft->setTextColor(color);
+    tft->print(p.body.substring(from, to));
+  }
+}
+
+// Lay out one page of p starting at char offset start, drawing it into the
+// page's rectangle when draw is set. Wrapping itself is wcWrapPage
+// (Layout.h). With syntax highlighting, lex is the lexer state at start on
+// entry and the state at the returned offset on exit.
+// Returns the offset of the following page (-1 = end of content).
+template <class Page>
+static int wcLayoutPage(Arduino_TFT *tft, Arduino_DataBus *bus, const Page &p, int start, bool draw,
+                        uint8_t &lex) {
+  int sz = constrain(p.textSize, 1, 3);
+  if (draw) tft->setTextSize(sz);
+
+  const int lineH   = wcLineH(sz);
+  const int maxX    = p.x + PANE_PAD;
+  const int startY  = p.y + PANE_PAD;
+  const int maxCols = wcLayoutCols(p.w, sz);
+  const int rows    = wcLayoutRows(p.h, sz);
+
+  if (draw) tft->fillRect(p.x, p.y, p.w, p.h, RGB565_BLACK);
+
+  const auto &body = p.body;
+  int bodyLen = body.length();
+  int lexPos  = start;  // how far the highlighter has got
+
+  int next = wcWrapPage(body, start, maxCols, rows, [&](int from, int to, int row) {
+    int y = startY + row * lineH;
+    if (p.lexRules) {
+      // The lexer sees every byte, including the blanks and newlines wrapping skipped
+      wcLexSkip(*p.lexRules, body, lexPos, from, bodyLen, lex);
+      if (draw) {
+        wcDrawRow(tft, bus, p, from, to, maxX, y, wc_theme->text[p.colorIdx == 6 ? 0 : p.colorIdx], &lex);
+      } else {
+        wcLexSkip(*p.lexRules, body, from, to, bodyLen, lex);
+      }
+      lexPos = to;
+    } else if (draw) {
+      uint16_t color = p.colorIdx == 6 ? wc_theme->multi[row % MULTI_COLOR_COUNT]
+                                       : wc_theme->text[p.colorIdx];
+      wcDrawRow(tft, bus, p, from, to, maxX, y, color, nullptr);
+    }
+  });
+  if (p.lexRules && next != -1) wcLexSkip(*p.lexRules, body, lexPos, next, bodyLen, lex);
+  return next;
+}
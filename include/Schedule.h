@@ -0,0 +1,98 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_system.h>
+
+// ---------------------------------------------------------------------------
+// Poll scheduler: decides when to fetch the file next from what the previous
+// fetches saw.
+//   new content - poll again at the minimum interval, the feed is active
+//   unchanged   - double the interval, up to the ceiling
+//   failed      - retry after POLL_RETRY_MS, doubling per failure up to the
+//                 maximum, so a dead network doesn't cost a TLS handshake
+//                 every minute
+// The ceiling is the maximum, or half the feed's typical change period once
+// two changes have been seen (a running average of the gaps between them),
+// so a feed that changes hourly is still caught within half an hour while a
+// dormant one backs off to the maximum. Every wait gets +-12.5 % jitter so
+// devices on the same feed don't poll in lockstep.
+//
+// Bounds are build flags, e.g. -DPOLL_MIN_MS=60000
+// ---------------------------------------------------------------------------
+#ifndef POLL_MIN_MS
+#define POLL_MIN_MS   (2UL * 60UL * 1000UL)   // 2 minutes
+#endif
+#ifndef POLL_MAX_MS
+#define POLL_MAX_MS   (60UL * 60UL * 1000UL)  // 1 hour
+#endif
+#ifndef POLL_RETRY_MS
+#define POLL_RETRY_MS (30UL * 1000UL)         // first retry after a failure
+#endif
+
+enum PollResult : uint8_t { POLL_FAILED, POLL_UNCHANGED, POLL_CHANGED };
+
+static uint32_t poll_interval    = POLL_MIN_MS;  // current wait while the fetches succeed
+static uint32_t poll_due         = 0;            // millis() of the next fetch
+static bool     poll_force       = true;         // fetch on the next loop (boot, user request)
+static uint32_t poll_change_ms   = 0;            // millis() of the last change, 0 = none yet
+static uint32_t poll_period      = 0;            // average ms between changes, 0 = unknown
+static uint8_t  poll_fails       = 0;            // failures in a row
+static bool     poll_loaded      = false;        // a document has been fetched since boot
+
+static String wcPollFmt(uint32_t ms) {
+  char buf[16];
+  uint32_t s = ms / 1000;
+  if (s >= 60) snprintf(buf, sizeof(buf), "%lum%02lus", (unsigned long)(s / 60), (unsigned long)(s % 60));
+  else         snprintf(buf, sizeof(buf), "%lus", (unsigned long)s);
+  return String(buf);
+}
+
+// Fetch on the next loop pass, whatever the schedule says
+static void wcPollNow() { poll_force = true; }
+
+static bool wcPollDue() { return poll_force || (int32_t)(millis() - poll_due) >= 0; }
+
+// Milliseconds until the next fetch is due, for the idle/sleep budget
+static uint32_t wcPollWait() {
+  if (poll_force) return 0;
+  int32_t left = (int32_t)(poll_due - millis());
+  return left > 0 ? left : 0;
+}
+
+// Record how a fetch went and schedule the next one
+static void wcPollResult(PollResult r) {
+  uint32_t now = millis();
+  poll_force = false;
+
+  uint32_t ceiling = POLL_MAX_MS;
+  if (poll_period) ceiling = constrain(poll_period / 2, POLL_MIN_MS, POLL_MAX_MS);
+
+  uint32_t wait;
+  if (r == POLL_FAILED) {
+    poll_fails = min(poll_fails + 1, 16);
+    wait = min((uint64_t)POLL_RETRY_MS << (poll_fails - 1), (uint64_t)POLL_MAX_MS);
+  } else {
+    poll_fails = 0;
+    if (r == POLL_CHANGED) {
+      // the first document after boot is a load, not a change
+      if (poll_loaded) {
+        if (poll_change_ms) {
+          uint32_t gap = now - poll_change_ms;
+          poll_period  = poll_period ? (poll_period * 3 + gap) / 4 : gap;
+        }
+        poll_change_ms = now;
+      }
+      poll_loaded   = true;
+      poll_interval = POLL_MIN_MS;
+    } else {
+      poll_interval = min(poll_interval * 2, ceiling);
+    }
+    wait = poll_interval;
+  }
+
+  wait = min(wait - wait / 8 + esp_random() % (wait / 4 + 1), (uint32_t)POLL_MAX_MS);
+  poll_due = now + wait;
+  Serial.printf("[Poll] %s, next in %s (change period %s)\n",
+                r == POLL_FAILED ? "failed" : r == POLL_CHANGED ? "changed" : "unchanged",
+                wcPollFmt(wait).c_str(), poll_period ? wcPollFmt(poll_period).c_str() : "unknown");
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <Arduino.h>
+#include <SPI.h>
+#include <WebServer.h>
+#include <Arduino_GFX_Library.h>
+#include "Trace.h"
+
+// ---------------------------------------------------------------------------
+// Screenshot: reads the ILI9341's frame memory back over MISO (pin 12 on the
+// CYD) and streams it to an HTTP client run-length encoded, so nobody has to
+// walk over to a display to see what it shows. The frame is read in strips
+// of SCREEN_STRIP rows and encoded as it comes off the bus; only one row
+// (960 bytes) and one output buffer are held, never the 150 KB frame.
+//
+// Stream format (little endian), decoded by tools/rle2png.py:
+//   "CYDR" u16 width, u16 height, u8 flags (bit 0 = panel inverted: the
+//   pixels are as stored, the screen shows their inverse), u8 0
+//   then packets until width x height pixels (row-major) are covered:
+//   varint n; n odd = run of n >> 1 pixels of the u16 RGB565 that follows,
+//   n even = n >> 1 literal RGB565 pixels follow
+// A text screen is mostly background, so it comes to a few KB.
+// ---------------------------------------------------------------------------
+#ifndef SCREEN_SPI_HZ
+#define SCREEN_SPI_HZ   10000000   // reads are slower than writes on the ILI9341
+#endif
+#define SCREEN_MAX_W    320
+#define SCREEN_STRIP    16
+#define SCREEN_BUDGET_MS 2000      // logged as over budget beyond this
+#define SCREEN_LIT_MAX  64         // pixels per literal packet
+#define SCREEN_OUT_BUF  1436       // one TCP segment
+
+struct ScreenStats {
+  uint32_t bytes;    // encoded size, header included
+  uint32_t readUs;   // SPI readback
+  uint32_t totalUs;  // including encode and send
+};
+
+class ScreenEncoder {
+public:
+  explicit ScreenEncoder(WebServer &server) : _server(server) {}
+
+  void header(int w, int h, bool inverted) {
+    const uint8_t hdr[10] = { 'C', 'Y', 'D', 'R', (uint8_t)w, (uint8_t)(w >> 8),
+                              (uint8_t)h, (uint8_t)(h >> 8), (uint8_t)inverted, 0 };
+    out(hdr, sizeof(hdr));
+  }
+
+  void pixel(uint16_t c) {
+    if (_run && c == _runColor) {
+      _run++;
+      return;
+    }
+    endRun();
+    _runColor = c;
+    _run      = 1;
+  }
+
+  uint32_t finish() {
+    endRun();
+    flushLiterals();
+    flush();
+    return _total;
+  }
+
+private:
+  WebServer &_server;
+  uint8_t    _buf[SCREEN_OUT_BUF];
+  int        _len = 0;
+  uint32_t   _total = 0;
+  uint16_t   _runColor = 0;
+  uint32_t   _run = 0;
+  uint16_t   _lit[SCREEN_LIT_MAX];
+  int        _litN = 0;
+
+  void flush() {
+    if (_len) _server.sendContent((const char *)_buf, _len);
+    _len = 0;
+  }
+
+  void out(const uint8_t *p, int n) {
+    _total += n;
+    while (n) {
+      int take = min(n, SCREEN_OUT_BUF - _len);
+      memcpy(_buf + _len, p, take);
+      _len += take;
+      p    += take;
+      n    -= take;
+      if (_len == SCREEN_OUT_BUF) flush();
+    }
+  }
+
+  void varint(uint32_t v) {
+    uint8_t b[5];
+    int n = 0;
+    do {
+      b[n++] = (v & 0x7F) | (v > 0x7F ? 0x80 : 0);
+      v >>= 7;
+    } while (v);
+    out(b, n);
+  }
+
+  void color(uint16_t c) {
+    const uint8_t b[2] = { (uint8_t)c, (uint8_t)(c >> 8) };
+    out(b, 2);
+  }
+
+  void flushLiterals() {
+    if (!_litN) return;
+    varint(_litN << 1);
+    for (int i = 0; i < _litN; i++) color(_lit[i]);
+    _litN = 0;
+  }
+
+  // Runs of 3 or more pay for their own packet; shorter ones join the literals
+  void endRun() {
+    if (_run >= 3) {
+      flushLiterals();
+      varint(_run << 1 | 1);
+      color(_runColor);
+    } else {
+      for (uint32_t i = 0; i < _run; i++) {
+        _lit[_litN++] = _runColor;
+        if (_litN == SCREEN_LIT_MAX) flushLiterals();
+      }
+    }
+    _run = 0;
+  }
+};
+
+// Read the panel back and send it as the response body. bus must be the
+// display's bus (for the address window); cs/dc are its pins.
+static ScreenStats wcScreenshot(WebServer &server, Arduino_DataBus *bus, int8_t cs, int8_t dc,
+                                int w, int h, bool inverted) {
+  ScreenStats st = {0, 0, 0};
+  uint32_t t0 = micros();
+  wcTraceBegin(TR_SCREEN);
+  server.setContentLength(CONTENT_LENGTH_UNKNOWN);
+  server.send(200, "application/octet-stream", "");
+
+  static uint8_t row[SCREEN_MAX_W * 3];
+  w = min(w, SCREEN_MAX_W);
+  ScreenEncoder enc(server);
+  enc.header(w, h, inverted);
+  for (int y0 = 0; y0 < h; y0 += SCREEN_STRIP) {
+    int y1 = min(y0 + SCREEN_STRIP, h) - 1;
+    bus->beginWrite();
+    bus->writeC8D16D16(0x2A, 0, w - 1);  // CASET
+    bus->writeC8D16D16(0x2B, y0, y1);    // PASET
+    bus->endWrite();
+
+    SPI.beginTransaction(SPISettings(SCREEN_SPI_HZ, MSBFIRST, SPI_MODE0));
+    digitalWrite(cs, LOW);
+    digitalWrite(dc, LOW);
+    SPI.transfer(0x2E);  // RAMRD
+    digitalWrite(dc, HIGH);
+    SPI.transfer(0);     // dummy byte before the first pixel
+    for (int y = y0; y <= y1; y++) {
+      uint32_t rr = micros();
+      SPI.transferBytes(nullptr, row, w * 3);  // 18-bit reads: R, G, B in the top 6 bits
+      st.readUs += micros() - rr;
+      for (int x = 0; x < w; x++) {
+        const uint8_t *p = row + x * 3;
+        enc.pixel((p[0] & 0xF8) << 8 | (p[1] & 0xFC) << 3 | p[2] >> 3);
+      }
+    }
+    digitalWrite(cs, HIGH);
+    SPI.endTransaction();
+  }
+  st.bytes = enc.finish();
+  server.sendContent("");  // last chunk
+  st.totalUs = micros() - t0;
+  wcTraceEnd(TR_SCREEN, st.bytes);
+
+  Serial.printf("[Screen] %dx%d: %lu bytes (%lu %%), %lu ms total, %lu ms SPI readback%s\n", w, h,
+                (unsigned long)st.bytes, (unsigned long)(100ULL * st.bytes / (w * h * 2)),
+                (unsigned long)(st.totalUs / 1000), (unsigned long)(st.readUs / 1000),
+                st.totalUs / 1000 > SCREEN_BUDGET_MS ? ", over budget" : "");
+  return st;
+}
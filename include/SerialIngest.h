@@ -0,0 +1,130 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_rom_crc.h>
+#include "Ingest.h"
+#include "Trace.h"
+
+// ---------------------------------------------------------------------------
+// Serial ingest: load a document over the USB serial link, for devices with
+// no WiFi. The console command "ingest [baud]" hands the port to this
+// protocol until the document is in (tools/serial_send.py is the sender):
+//
+//   device  #READY <baud> <frame max> <window>      at the console baud
+//           ... both sides switch to <baud> ...
+//   host    A5 seq:u16 len:u16 payload[len] crc:u32 (little endian; CRC-32
+//           of seq, len and payload, as zlib.crc32); len 0 ends the document
+//   device  #ACK <n>     frames before n are in (cumulative)
+//           #NAK <n>     bad or out-of-order frame, resend from n
+//           (the end frame is acked too, then the document is shown)
+//           #DONE <bytes> <changed 0/1> <ms>   or   #FAIL <reason>
+//           ... device goes back to the console baud ...
+//
+// The host keeps at most SERIAL_WINDOW frames unacknowledged, which fits in
+// the UART receive buffer, so a flash erase stalling the writer can't
+// overrun it. Frames go straight into an IngestSink, the same path as a
+// download (hash, unchanged check, table scan), and the document is shown
+// the moment the end frame lands. Reply lines start with '#' so the host can
+// pick them out of log output. Nothing else runs while a transfer is on.
+// ---------------------------------------------------------------------------
+#define SERIAL_BAUD       115200
+#define SERIAL_RX_BUFFER  4096   // set before Serial.begin()
+#define SERIAL_FRAME_MAX  512
+#define SERIAL_WINDOW     4      // 4 x 520 bytes in flight, well inside the RX buffer
+#define SERIAL_TIMEOUT_MS 3000   // silence that ends a transfer
+#define SERIAL_SOF        0xA5
+
+static const uint32_t SERIAL_BAUDS[] = { 115200, 230400, 460800, 921600, 1500000, 2000000 };
+
+// Puts a finished sink on screen; false if it matched what is already shown
+typedef bool (*SerialShowFn)(IngestSink &sink, const char *tag);
+
+// Read exactly n bytes; false after SERIAL_TIMEOUT_MS without any
+static bool wcSerialRead(uint8_t *buf, int n) {
+  uint32_t last = millis();
+  int got = 0;
+  while (got < n) {
+    int avail = Serial.available();
+    if (avail > 0) {
+      got += Serial.read(buf + got, min(avail, n - got));
+      last = millis();
+    } else if (millis() - last > SERIAL_TIMEOUT_MS) {
+      return false;
+    } else {
+      delay(1);
+    }
+  }
+  return true;
+}
+
+// Run one transfer at baud. Blocks until the document is in or the host goes
+// quiet; the console baud is restored either way.
+static bool wcSerialIngest(uint32_t baud, SerialShowFn show) {
+  bool known = false;
+  for (uint32_t b : SERIAL_BAUDS) known |= b == baud;
+  if (!known) {
+    Serial.printf("#FAIL baud %lu not supported\n", (unsigned long)baud);
+    return false;
+  }
+  Serial.printf("#READY %lu %d %d\n", (unsigned long)baud, SERIAL_FRAME_MAX, SERIAL_WINDOW);
+  Serial.flush();
+  if (baud != SERIAL_BAUD) Serial.updateBaudRate(baud);
+
+  wcTraceBegin(TR_SERIAL);
+  uint32_t t0   = millis();
+  IngestSink *sink = new IngestSink;
+  static uint8_t frame[SERIAL_FRAME_MAX + 4];
+  uint8_t  hdr[4];
+  uint16_t expect = 0;
+  uint32_t frames = 0, bad = 0;
+  bool     naked  = false;  // one NAK per gap; the host's timeout covers the rest
+  const char *fail = nullptr;
+
+  while (true) {
+    uint8_t b;
+    if (!wcSerialRead(&b, 1)) { fail = "timeout"; break; }
+    if (b != SERIAL_SOF) continue;  // resync on the next start byte
+    if (!wcSerialRead(hdr, 4)) { fail = "timeout"; break; }
+    uint16_t seq = hdr[0] | hdr[1] << 8;
+    uint16_t len = hdr[2] | hdr[3] << 8;
+    bool ok = len <= SERIAL_FRAME_MAX;
+    if (ok && !wcSerialRead(frame, len + 4)) { fail = "timeout"; break; }
+    if (ok) {
+      uint32_t crc = esp_rom_crc32_le(esp_rom_crc32_le(0, hdr, 4), frame, len);
+      ok = crc == (frame[len] | frame[len + 1] << 8 | frame[len + 2] << 16 | (uint32_t)frame[len + 3] << 24);
+    }
+    if (!ok) bad++;
+    if (!ok || seq != expect) {
+      if (ok && (uint16_t)(expect - seq) < 0x8000) {  // already have it: the host went back too far
+        Serial.printf("#ACK %u\n", expect);
+      } else if (!naked) {
+        Serial.printf("#NAK %u\n", expect);
+        naked = true;
+      }
+      continue;
+    }
+    if (len && sink->write(frame, len) != len) { fail = "document too large"; break; }
+    expect++;
+    naked = false;
+    Serial.printf("#ACK %u\n", expect);  // the end frame too, before the slow part
+    if (len == 0) break;
+    frames++;
+  }
+
+  int  bytes   = sink->length();
+  bool changed = false;
+  if (!fail && (bytes == 0 || !sink->finish())) fail = bytes ? "store failed" : "empty document";
+  if (!fail) changed = show(*sink, "Serial");
+  delete sink;
+  uint32_t ms = millis() - t0;
+  wcTraceEnd(TR_SERIAL, fail ? 0 : changed ? 2 : 1);
+
+  if (fail) Serial.printf("#FAIL %s\n", fail);
+  else      Serial.printf("#DONE %d %d %lu\n", bytes, changed, (unsigned long)ms);
+  Serial.flush();
+  if (baud != SERIAL_BAUD) Serial.updateBaudRate(SERIAL_BAUD);
+  Serial.printf("[Serial] %d bytes in %lu ms at %lu baud, %lu frames, %lu bad%s%s\n", bytes,
+                (unsigned long)ms, (unsigned long)baud, (unsigned long)frames, (unsigned long)bad,
+                fail ? ", failed: " : "", fail ? fail : "");
+  return !fail;
+}
@@ -0,0 +1,215 @@
+#pragma once
+
+#include <Arduino.h>
+#include <vector>
+#include "DocStore.h"
+#include "Highlight.h"
+
+// ---------------------------------------------------------------------------
+// CSV/TSV tables. While a document streams into the IngestSink, TableScan
+// watches the bytes go by and records the offset of every row and the
+// widest cell of every column, so a table needs no second pass before it can
+// be paged. Quoted cells ("a, b" and "" escapes) are understood.
+//
+// A document is a table when its URL ends in .csv or .tsv, or, for any other
+// file, when the first line has commas or tabs and at least 90 % of the rows
+// have the same number of cells as that header.
+// ---------------------------------------------------------------------------
+#define TABLE_MAX_COLS 32
+#define TABLE_MAX_ROWS 20000   // 80 KB of row index; larger files stay text
+#define TABLE_CELL_MAX 60      // widths are counted up to this
+#define TABLE_HEAD_MAX 1024    // header line buffered for separator detection
+
+struct TableIndex {
+  char             sep  = 0;   // ',' or '\t'; 0 = not a table
+  int              cols = 0;   // cells in the header row
+  uint8_t          width[TABLE_MAX_COLS] = {};  // widest cell per column, in chars
+  std::vector<int> rows;       // offset of every row, header first
+};
+
+// Separator implied by the URL's extension, 0 = decide from the header
+static char wcTableSepForUrl(const char *url) {
+  int len;
+  const char *ext = wcUrlExt(url, len);
+  if (ext && len == 3 && strncasecmp(ext, "csv", 3) == 0) return ',';
+  if (ext && len == 3 && strncasecmp(ext, "tsv", 3) == 0) return '\t';
+  return 0;
+}
+
+class TableScan {
+public:
+  TableIndex idx;
+
+  // sep: the URL's separator, or 0 to detect it from the header
+  void begin(char sep) {
+    idx = TableIndex();
+    _forced  = sep;
+    _state   = SCAN_HEAD;
+    _head.clear();
+    _head.reserve(128);
+    _pos     = 0;
+    _quote = _closed = false;
+    _col = _cell = _rowChars = 0;
+    _rowStart = true;
+    _matching = 0;
+  }
+
+  void feed(const uint8_t *buf, size_t n) {
+    for (size_t i = 0; i < n && _state != SCAN_OFF; i++) {
+      char c = buf[i];
+      if (_state == SCAN_HEAD && _head.size() == TABLE_HEAD_MAX) {
+        if (!_forced) {
+          _state = SCAN_OFF;  // nobody writes headers this long
+          break;
+        }
+        startRows();  // the extension says table; go on with what we have
+      }
+      if (_state == SCAN_HEAD) {
+        _head.push_back(c);
+        if (c == '\n') startRows();
+      } else {
+        byte(c);
+      }
+    }
+  }
+
+  // Call after the last byte. True (and idx filled in) if the document is a table.
+  bool finish() {
+    if (_state == SCAN_HEAD) startRows();
+    if (_state == SCAN_ROWS && (_col || _rowChars)) {
+      endCell();
+      endRow();
+    }
+    bool ok = _state == SCAN_ROWS && idx.cols >= 2 && idx.rows.size() >= 2 &&
+              (_forced || _matching * 10 >= idx.rows.size() * 9);
+    if (!ok) {
+      idx = TableIndex();
+      return false;
+    }
+    Serial.printf("[Table] %d columns, %d rows, '%s' separated\n",
+                  idx.cols, (int)idx.rows.size(), idx.sep == '\t' ? "tab" : ",");
+    return true;
+  }
+
+private:
+  enum ScanState : uint8_t { SCAN_HEAD, SCAN_ROWS, SCAN_OFF };
+
+  char      _forced   = 0;
+  ScanState _state    = SCAN_OFF;
+  std::vector<char> _head;      // header line until the separator is known
+  int       _pos      = 0;      // document offset of the next byte in byte()
+  bool      _quote    = false;  // inside a quoted cell
+  bool      _closed   = false;  // just saw a closing quote ("" = literal quote)
+  bool      _rowStart = true;
+  int       _col = 0, _cell = 0, _rowChars = 0;
+  uint32_t  _matching = 0;      // rows with as many cells as the header
+
+  // Header complete: pick the separator, then scan it like any other row
+  void startRows() {
+    char sep = _forced;
+    if (!sep) {
+      int commas = 0, tabs = 0;
+      bool q = false;
+      for (char c : _head) {
+        if (c == '"') q = !q;
+        else if (!q && c == ',')  commas++;
+        else if (!q && c == '\t') tabs++;
+      }
+      sep = tabs ? '\t' : commas ? ',' : 0;
+    }
+    std::vector<char> head;
+    head.swap(_head);
+    if (!sep) {
+      _state = SCAN_OFF;
+      return;
+    }
+    idx.sep = sep;
+    _state  = SCAN_ROWS;
+    for (char c : head) byte(c);
+  }
+
+  void byte(char c) {
+    if (_rowStart) {
+      if (idx.rows.size() >= TABLE_MAX_ROWS) {
+        _state = SCAN_OFF;
+        return;
+      }
+      idx.rows.push_back(_pos);
+      _rowStart = false;
+    }
+    _pos++;
+    if (c != '\r' && c != '\n') _rowChars++;
+
+    if (_quote) {
+      if (c == '"') { _quote = false; _closed = true; }
+      else          _cell++;
+      return;
+    }
+    if (c == '"') {
+      if (_closed)        { _cell++; _quote = true; }  // "" inside quotes
+      else if (!_cell)    _quote = true;
+      else                _cell++;
+      _closed = false;
+      return;
+    }
+    _closed = false;
+    if (c == idx.sep) {
+      endCell();
+    } else if (c == '\n') {
+      endCell();
+      endRow();
+    } else if (c != '\r') {
+      _cell++;
+    }
+  }
+
+  void endCell() {
+    if (_col < TABLE_MAX_COLS) {
+      uint8_t w = min(_cell, TABLE_CELL_MAX);
+      if (w > idx.width[_col]) idx.width[_col] = w;
+    }
+    _col++;
+    _cell = 0;
+  }
+
+  void endRow() {
+    if (_rowChars == 0) {
+      idx.rows.pop_back();  // blank line
+    } else {
+      if (idx.rows.size() == 1) idx.cols = min(_col, TABLE_MAX_COLS);
+      if (_col == idx.cols) _matching++;
+    }
+    _col = _rowChars = 0;
+    _rowStart = true;
+  }
+};
+
+// Read the cell at pos into out (at most max chars; len is set to the full
+// length) and return where the next cell starts; last is set at the row end.
+static int wcTableCell(const DocStore &d, int pos, char sep, char *out, int max, int &len, bool &last) {
+  int  end    = d.length();
+  bool quote  = false, closed = false;
+  len  = 0;
+  last = false;
+  for (; pos < end; pos++) {
+    char c = d[pos];
+    if (quote) {
+      if (c == '"') { quote = false; closed = true; }
+      else if (len++ < max) out[len - 1] = c == '\n' ? ' ' : c;
+      continue;
+    }
+    if (c == '"') {
+      if (closed)            { if (len++ < max) out[len - 1] = '"'; quote = true; }
+      else if (!len)         quote = true;
+      else if (len++ < max)  out[len - 1] = c;
+      closed = false;
+      continue;
+    }
+    closed = false;
+    if (c == sep) return pos + 1;
+    if (c == '\n') break;
+    if (c != '\r' && len++ < max) out[len - 1] = c;
+  }
+  last = true;
+  return pos;
+}
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <Arduino.h>
+#include "Highlight.h"
+
+// ---------------------------------------------------------------------------
+// Color themes. Every color below is written as it should look on screen.
+// The light theme runs the panel inverted (invertDisplay(true)), so the black
+// background shows white; its drawn colors are the bitwise inverse of the
+// intended ones. That inversion, and the blends for the footer gray and the
+// pane rules, are all worked out at compile time: drawing only indexes a
+// table, whatever the theme.
+//
+// The default comes from the build (-DTHEME_DEFAULT=1 in
+// env:esp32dev-inverted); the setup portal can override it per device.
+// ---------------------------------------------------------------------------
+#ifndef THEME_DEFAULT
+#define THEME_DEFAULT 0   // 0 = dark, 1 = light (inverted panel)
+#endif
+
+#define TEXT_COLOR_COUNT  6   // picked in the portal; index 6 = rainbow
+#define MULTI_COLOR_COUNT 7   // rainbow line colors
+
+enum ThemeId : uint8_t { THEME_DARK, THEME_LIGHT, THEME_COUNT };
+
+template <int N> struct Palette {
+  uint16_t c[N];
+  constexpr uint16_t operator[](int i) const { return c[i]; }
+};
+
+template <int N> constexpr bool operator==(const Palette<N> &a, const Palette<N> &b) {
+  for (int i = 0; i < N; i++) {
+    if (a.c[i] != b.c[i]) return false;
+  }
+  return true;
+}
+
+constexpr uint16_t wcInvert565(uint16_t c) { return (uint16_t)~c; }
+
+// a + (b - a) * t / 255 on one channel, rounded
+constexpr int wcMixChannel(int a, int b, int t) { return (a * (255 - t) + b * t + 127) / 255; }
+
+// Blend b over a with weight t / 255, per RGB565 channel
+constexpr uint16_t wcBlend565(uint16_t a, uint16_t b, uint8_t t) {
+  return wcMixChannel(a >> 11, b >> 11, t) << 11 |
+         wcMixChannel(a >> 5 & 0x3F, b >> 5 & 0x3F, t) << 5 |
+         wcMixChannel(a & 0x1F, b & 0x1F, t);
+}
+
+constexpr uint16_t wcDrawn(uint16_t c, bool invert) { return invert ? wcInvert565(c) : c; }
+
+template <int N> constexpr Palette<N> wcDrawn(const Palette<N> &p, bool invert) {
+  Palette<N> out{};
+  for (int i = 0; i < N; i++) out.c[i] = wcDrawn(p.c[i], invert);
+  return out;
+}
+
+// A theme as it should look on screen
+struct ThemeColors {
+  uint16_t                   bg, ink;    // background, default text
+  Palette<TEXT_COLOR_COUNT>  text;       // white/black, green, cyan, yellow, orange, red
+  Palette<MULTI_COLOR_COUNT> multi;
+  Palette<LEX_CLASS_COUNT>   highlight;  // by LexClass; LEX_PLAIN is unused
+};
+
+// A theme as drawn: what the render code reads
+struct Theme {
+  const char                *inkName;    // portal name of text color 0
+  bool                       invert;     // panel inversion on
+  uint16_t                   bg, ink;
+  uint16_t                   gray;       // footer and timestamp
+  uint16_t                   rule;       // lines between dashboard panes
+  Palette<TEXT_COLOR_COUNT>  text;
+  Palette<MULTI_COLOR_COUNT> multi;
+  Palette<LEX_CLASS_COUNT>   highlight;
+};
+
+constexpr Theme wcMakeTheme(const char *inkName, bool invert, const ThemeColors &s) {
+  return Theme{ inkName, invert,
+                wcDrawn(s.bg, invert), wcDrawn(s.ink, invert),
+                wcDrawn(wcBlend565(s.bg, s.ink, 124), invert),
+                wcDrawn(wcBlend565(s.bg, s.ink, 59), invert),
+                wcDrawn(s.text, invert), wcDrawn(s.multi, invert), wcDrawn(s.highlight, invert) };
+}
+
+static constexpr ThemeColors DARK_COLORS = {
+  0x0000, 0xFFFF,
+  {{ 0xFFFF, 0x07E0, 0x07FF, 0xFFE0, 0xFD20, 0xF800 }},
+  {{ 0x07FF, 0x07E0, 0xFFE0, 0xFD20, 0xF800, 0xF81F, 0xFFFF }},
+  {{ 0xFFFF,    // plain
+     0x54FA,    // keyword  blue
+     0xCC8F,    // string   salmon
+     0x6CCA,    // comment  green
+     0xB675,    // number   pale green
+     0x9EFF }}, // key      sky blue
+};
+
+// White background: black text, and darker syntax colors that read on white
+static constexpr ThemeColors LIGHT_COLORS = {
+  0xFFFF, 0x0000,
+  {{ 0x0000, 0x07E0, 0x07FF, 0xFFE0, 0xFD20, 0xF800 }},
+  {{ 0x07FF, 0x07E0, 0xFFE0, 0xF800, 0xF81F, 0xFD20, 0x0000 }},
+  {{ 0x0000,    // plain
+     0x0019,    // keyword  dark blue
+     0xA0A2,    // string   dark red
+     0x0400,    // comment  green
+     0x0C2B,    // number   teal
+     0x0294 }}, // key      steel blue
+};
+
+static constexpr Theme THEMES[THEME_COUNT] = {
+  wcMakeTheme("White", false, DARK_COLORS),
+  wcMakeTheme("Black", true,  LIGHT_COLORS),
+};
+
+// Both themes draw on black with white ink; the light one gets its white
+// background from the panel. The render code relies on this for fills.
+static_assert(THEMES[THEME_DARK].bg == 0x0000 && THEMES[THEME_LIGHT].bg == 0x0000, "themes draw on black");
+static_assert(THEMES[THEME_DARK].ink == 0xFFFF && THEMES[THEME_LIGHT].ink == 0xFFFF, "themes draw white ink");
+
+// Inverting what the light theme draws gives back the intended colors
+static_assert(wcDrawn(THEMES[THEME_LIGHT].text, true) == LIGHT_COLORS.text, "light text palette");
+static_assert(wcDrawn(THEMES[THEME_LIGHT].multi, true) == LIGHT_COLORS.multi, "light rainbow palette");
+static_assert(wcDrawn(THEMES[THEME_LIGHT].highlight, true) == LIGHT_COLORS.highlight, "light highlight palette");
+
+// ... and matches the hand-inverted tables of the old INVERTED firmware
+static_assert(THEMES[THEME_LIGHT].text == Palette<TEXT_COLOR_COUNT>{{ 0xFFFF, 0xF81F, 0xF800, 0x001F, 0x02DF, 0x07FF }},
+              "light text palette drawn");
+static_assert(THEMES[THEME_LIGHT].multi == Palette<MULTI_COLOR_COUNT>{{ 0xF800, 0xF81F, 0x001F, 0x07FF, 0x07E0, 0x02DF, 0xFFFF }},
+              "light rainbow palette drawn");
+static_assert(THEMES[THEME_LIGHT].highlight == Palette<LEX_CLASS_COUNT>{{ 0xFFFF, 0xFFE6, 0x5F5D, 0xFBFF, 0xF3D4, 0xFD6B }},
+              "light highlight palette drawn");
+
+// The blends reproduce the grays both firmwares used to hard-code
+static_assert(THEMES[THEME_DARK].gray == 0x7BEF && THEMES[THEME_LIGHT].gray == 0x7BEF, "footer gray");
+static_assert(THEMES[THEME_DARK].rule == 0x39E7, "pane rule");
+
+static const Theme *wc_theme = &THEMES[THEME_DEFAULT];
+
+static inline void wcThemeSelect(int id) {
+  wc_theme = &THEMES[constrain(id, 0, THEME_COUNT - 1)];
+}
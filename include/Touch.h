@@ -0,0 +1,282 @@
+#pragma once
+
+#include <Arduino_GFX_Library.h>
+#include <XPT2046_Touchscreen.h>
+#include <Preferences.h>
+
+// gfx and ts are defined in main.cpp
+extern Arduino_GFX         *gfx;
+extern XPT2046_Touchscreen  ts;
+
+// ---------------------------------------------------------------------------
+// Tuning
+// ---------------------------------------------------------------------------
+#define TOUCH_SAMPLE_MS       5      // 200 Hz sampling while the IRQ is active
+#define TOUCH_MIN_Z           400    // pressure below this counts as "not touching"
+#define TOUCH_RELEASE_SAMPLES 3      // consecutive light samples before we call it a release
+#define TOUCH_TAP_SLOP        12     // px of travel still treated as a stationary finger
+#define TOUCH_SWIPE_MIN       40     // px of travel before a move becomes a swipe
+#define TOUCH_LONG_MS         700    // stationary hold that fires a long press
+#define TOUCH_HOLD_MS         1500   // contact this long ends as a hold (no gesture), so a resting
+                                     // palm or a stuck controller can't keep loop() waiting
+#define TOUCH_FLING_MIN_VEL   900    // px/s at release that upgrades a swipe to a fling
+#define TOUCH_FLING_FRICTION  2500   // px/s^2 deceleration used to turn a fling into a distance
+#define TOUCH_FLING_MAX_PAGES 10
+#define TOUCH_VEL_WINDOW_MS   60     // velocity is measured over the last ~60 ms of contact
+#define TOUCH_HIST            16     // sample ring, >= TOUCH_VEL_WINDOW_MS / TOUCH_SAMPLE_MS
+
+enum TouchGestureType : uint8_t {
+  GESTURE_NONE = 0,
+  GESTURE_TAP,
+  GESTURE_LONG_PRESS,
+  GESTURE_SWIPE_LEFT,   // finger moved right-to-left
+  GESTURE_SWIPE_RIGHT,
+  GESTURE_SWIPE_UP,
+  GESTURE_SWIPE_DOWN,
+  GESTURE_FLING_LEFT,
+  GESTURE_FLING_RIGHT,
+};
+
+struct TouchGesture {
+  TouchGestureType type;
+  int16_t  x, y;        // screen position where the touch started
+  int16_t  dx, dy;      // total travel in px
+  int16_t  vx, vy;      // release velocity in px/s
+  uint16_t durationMs;  // finger-down time
+  uint8_t  pages;       // fling only: pages the inertia carries us
+  uint32_t latencyUs;   // last contact sample -> gesture reported
+};
+
+// ---------------------------------------------------------------------------
+// Calibration (raw ADC range mapped onto the 320x240 landscape screen)
+// ---------------------------------------------------------------------------
+static int wc_tcal_x0 = 200, wc_tcal_x1 = 3700;
+static int wc_tcal_y0 = 240, wc_tcal_y1 = 3800;
+
+static void wcLoadTouchCal() {
+  Preferences prefs;
+  prefs.begin("githubraw", true);
+  wc_tcal_x0 = prefs.getInt("tcx0", 200);
+  wc_tcal_x1 = prefs.getInt("tcx1", 3700);
+  wc_tcal_y0 = prefs.getInt("tcy0", 240);
+  wc_tcal_y1 = prefs.getInt("tcy1", 3800);
+  prefs.end();
+}
+
+static void wcSaveTouchCal() {
+  Preferences prefs;
+  prefs.begin("githubraw", false);
+  prefs.putInt("tcx0", wc_tcal_x0);
+  prefs.putInt("tcx1", wc_tcal_x1);
+  prefs.putInt("tcy0", wc_tcal_y0);
+  prefs.putInt("tcy1", wc_tcal_y1);
+  prefs.end();
+}
+
+static int wcTouchMapX(int raw) { return constrain(map(raw, wc_tcal_x0, wc_tcal_x1, 0, gfx->width()),  0, gfx->width()  - 1); }
+static int wcTouchMapY(int raw) { return constrain(map(raw, wc_tcal_y0, wc_tcal_y1, 0, gfx->height()), 0, gfx->height() - 1); }
+
+// Average the raw reading of a finger held still for ~0.5 s.
+static bool wcTouchSampleRaw(int &rx, int &ry) {
+  unsigned long start = millis();
+  while (!ts.touched()) {
+    if (millis() - start > 15000) return false;
+    delay(10);
+  }
+  delay(100);  // let the finger settle
+  long sx = 0, sy = 0;
+  int  n  = 0;
+  while (n < 32 && ts.touched()) {
+    TS_Point p = ts.getPoint();
+    sx += p.x; sy += p.y; n++;
+    delay(TOUCH_SAMPLE_MS * 3);
+  }
+  while (ts.touched()) delay(10);
+  if (n < 8) return false;
+  rx = sx / n;
+  ry = sy / n;
+  return true;
+}
+
+static void wcDrawCalTarget(int x, int y, uint16_t color) {
+  gfx->drawFastHLine(x - 10, y, 21, color);
+  gfx->drawFastVLine(x, y - 10, 21, color);
+  gfx->drawCircle(x, y, 5, color);
+}
+
+// Two-point calibration: touch the top-left then the bottom-right target.
+// The raw range is extrapolated to the screen edges and saved to NVS.
+static bool wcTouchCalibrate() {
+  const int ax = 20, ay = 20;
+  const int bx = gfx->width() - 20, by = gfx->height() - 20;
+  int rax, ray, rbx, rby;
+
+  gfx->fillScreen(RGB565_BLACK);
+  gfx->setTextSize(1);
+  gfx->setTextColor(RGB565_WHITE);
+  gfx->setCursor(60, 110);
+  gfx->print("Touch the crosshair and hold");
+
+  wcDrawCalTarget(ax, ay, 0xFFE0);
+  if (!wcTouchSampleRaw(rax, ray)) return false;
+  wcDrawCalTarget(ax, ay, RGB565_BLACK);
+  wcDrawCalTarget(bx, by, 0xFFE0);
+  if (!wcTouchSampleRaw(rbx, rby)) return false;
+
+  if (abs(rbx - rax) < 500 || abs(rby - ray) < 500) {
+    Serial.println("[Touch] calibration rejected (targets too close)");
+    return false;
+  }
+  float sx = (float)(rbx - rax) / (bx - ax);
+  float sy = (float)(rby - ray) / (by - ay);
+  wc_tcal_x0 = rax - ax * sx;
+  wc_tcal_x1 = wc_tcal_x0 + gfx->width()  * sx;
+  wc_tcal_y0 = ray - ay * sy;
+  wc_tcal_y1 = wc_tcal_y0 + gfx->height() * sy;
+  wcSaveTouchCal();
+  Serial.printf("[Touch] calibrated x=%d..%d y=%d..%d\n", wc_tcal_x0, wc_tcal_x1, wc_tcal_y0, wc_tcal_y1);
+  return true;
+}
+
+// ---------------------------------------------------------------------------
+// Sampling and gesture recognition
+// ---------------------------------------------------------------------------
+struct TouchSample { uint32_t t; int16_t x, y; };
+
+// Latency statistics, printed by the caller
+static uint32_t wc_touch_lat_last = 0;
+static uint32_t wc_touch_lat_max  = 0;
+static uint32_t wc_touch_lat_sum  = 0;
+static uint32_t wc_touch_lat_n    = 0;
+
+static bool wc_touch_held = false;  // contact ended early (long press, hold): ignored until it lifts
+
+static int16_t wcMedian3(int16_t a, int16_t b, int16_t c) {
+  if (a > b) { int16_t t = a; a = b; b = t; }
+  if (b > c) b = c;
+  return a > b ? a : b;
+}
+
+// Velocity in px/s over the newest TOUCH_VEL_WINDOW_MS of the ring.
+static void wcTouchVelocity(const TouchSample *ring, int count, int head, int16_t &vx, int16_t &vy) {
+  vx = vy = 0;
+  if (count < 2) return;
+  const TouchSample &last = ring[(head + TOUCH_HIST - 1) % TOUCH_HIST];
+  int back = 1;
+  while (back < count - 1) {
+    const TouchSample &s = ring[(head + TOUCH_HIST - 1 - back) % TOUCH_HIST];
+    if (last.t - s.t >= TOUCH_VEL_WINDOW_MS) break;
+    back++;
+  }
+  const TouchSample &first = ring[(head + TOUCH_HIST - 1 - back) % TOUCH_HIST];
+  uint32_t dt = last.t - first.t;
+  if (dt == 0) return;
+  vx = (int32_t)(last.x - first.x) * 1000 / (int32_t)dt;
+  vy = (int32_t)(last.y - first.y) * 1000 / (int32_t)dt;
+}
+
+// Poll the touch controller. Returns false immediately when the IRQ line is
+// idle. Otherwise samples at TOUCH_SAMPLE_MS until the finger lifts, a long
+// press fires or TOUCH_HOLD_MS pass, filters the track and classifies it into
+// a gesture. Whatever is left of a contact ended early is ignored.
+static bool wcTouchPoll(TouchGesture &g) {
+  if (!ts.tirqTouched()) return false;
+  if (!ts.touched()) { wc_touch_held = false; return false; }
+  if (wc_touch_held) return false;
+
+  TouchSample ring[TOUCH_HIST];
+  int     head = 0, count = 0;
+  int16_t rawX[3], rawY[3];
+  int     rawN = 0;
+  int16_t fx = 0, fy = 0;         // filtered position
+  int16_t x0 = 0, y0 = 0;         // first filtered position
+  int     maxTravel = 0;
+  int     light = 0;
+  uint32_t down     = millis();
+  uint32_t lastHit  = micros();
+  uint32_t next     = down;
+  bool     longFired = false;
+  bool     held      = false;
+
+  memset(&g, 0, sizeof(g));
+
+  while (true) {
+    while ((int32_t)(millis() - next) < 0) delayMicroseconds(200);
+    next += TOUCH_SAMPLE_MS;
+
+    TS_Point p = ts.getPoint();
+    if (p.z < TOUCH_MIN_Z) {
+      if (++light >= TOUCH_RELEASE_SAMPLES) break;
+      continue;
+    }
+    light   = 0;
+    lastHit = micros();
+
+    // Temporal median of three kills single-sample spikes, then a light IIR
+    rawX[rawN % 3] = wcTouchMapX(p.x);
+    rawY[rawN % 3] = wcTouchMapY(p.y);
+    rawN++;
+    int16_t mx = rawN >= 3 ? wcMedian3(rawX[0], rawX[1], rawX[2]) : rawX[(rawN - 1) % 3];
+    int16_t my = rawN >= 3 ? wcMedian3(rawY[0], rawY[1], rawY[2]) : rawY[(rawN - 1) % 3];
+    if (rawN == 1) { fx = x0 = mx; fy = y0 = my; }
+    fx = (fx + mx) / 2;
+    fy = (fy + my) / 2;
+
+    ring[head] = { (uint32_t)millis(), fx, fy };
+    head = (head + 1) % TOUCH_HIST;
+    if (count < TOUCH_HIST) count++;
+
+    int travel = max(abs(fx - x0), abs(fy - y0));
+    if (travel > maxTravel) maxTravel = travel;
+
+    if (!longFired && maxTravel < TOUCH_TAP_SLOP && millis() - down >= TOUCH_LONG_MS) {
+      longFired = true;
+      g.type = GESTURE_LONG_PRESS;
+      g.x = x0; g.y = y0;
+      g.durationMs = millis() - down;
+      g.latencyUs  = micros() - lastHit;
+      wc_touch_held = true;  // so the release doesn't also tap
+      break;
+    }
+    if (millis() - down >= TOUCH_HOLD_MS) {
+      held = wc_touch_held = true;
+      break;
+    }
+  }
+
+  if (rawN == 0 || held) return false;  // IRQ glitch with no real contact, or a hold
+
+  if (!longFired) {
+    g.x = x0;
+    g.y = y0;
+    g.dx = fx - x0;
+    g.dy = fy - y0;
+    g.durationMs = millis() - down;
+    wcTouchVelocity(ring, count, head, g.vx, g.vy);
+
+    if (abs(g.dx) < TOUCH_SWIPE_MIN && abs(g.dy) < TOUCH_SWIPE_MIN) {
+      g.type = maxTravel < TOUCH_SWIPE_MIN ? GESTURE_TAP : GESTURE_NONE;
+    } else if (abs(g.dx) >= abs(g.dy)) {
+      if (abs(g.vx) >= TOUCH_FLING_MIN_VEL) {
+        // Coast to a stop under constant friction: d = v^2 / 2a, one page per screen width.
+        // The release velocity sets the direction too: a drag one way that ends in a
+        // flick the other way flings the way of the flick.
+        float v    = abs(g.vx);
+        float dist = v * v / (2.0f * TOUCH_FLING_FRICTION);
+        g.pages = constrain((int)(dist / gfx->width()) + 1, 2, TOUCH_FLING_MAX_PAGES);
+        g.type  = g.vx < 0 ? GESTURE_FLING_LEFT : GESTURE_FLING_RIGHT;
+      } else {
+        g.type = g.dx < 0 ? GESTURE_SWIPE_LEFT : GESTURE_SWIPE_RIGHT;
+      }
+    } else {
+      g.type = g.dy < 0 ? GESTURE_SWIPE_UP : GESTURE_SWIPE_DOWN;
+    }
+    g.latencyUs = micros() - lastHit;
+  }
+
+  wc_touch_lat_last = g.latencyUs;
+  if (g.latencyUs > wc_touch_lat_max) wc_touch_lat_max = g.latencyUs;
+  wc_touch_lat_sum += g.latencyUs;
+  wc_touch_lat_n++;
+  return g.type != GESTURE_NONE;
+}
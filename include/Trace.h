@@ -0,0 +1,111 @@
+#pragma once
+
+#include <Arduino.h>
+#include <esp_attr.h>
+#include <esp_system.h>
+#include <esp_timer.h>
+
+// ---------------------------------------------------------------------------
+// Event tracer: fixed 12-byte records (timestamp, event id, argument) in a
+// ring buffer in RTC slow memory. RTC_NOINIT memory is left alone by every
+// reset except power-on, so after a watchdog or panic reset the events that
+// led up to it are still there. Slots are claimed with an atomic increment,
+// so both cores can trace without a lock.
+//
+// The "trace" console command dumps the ring as text; tools/trace2json.py
+// turns that into Chrome trace_event JSON (chrome://tracing, Perfetto).
+// ---------------------------------------------------------------------------
+#define TRACE_EVENTS 256  // power of two; 3 KB of the 8 KB RTC slow memory
+#define TRACE_MAGIC  0x54524331  // "TRC1"
+
+enum TraceId : uint8_t {
+  TR_BOOT = 0,  // arg = esp_reset_reason()
+  TR_REFRESH,   // fetchAndRender(), end arg = 0 failed, 1 unchanged, 2 new content
+  TR_FETCH,     // https_fetch(), end arg = bytes
+  TR_TLS,       // TCP connect + TLS handshake, end arg = 1 ok
+  TR_BODY,      // response body streaming, end arg = bytes
+  TR_LAYOUT,    // page index build, end arg = pages
+  TR_DRAW,      // renderPage(), arg = page
+  TR_TOUCH,     // gesture, arg = TouchGestureType
+  TR_SLEEP,     // light sleep, end arg = wakeup cause
+  TR_PUSH,      // LAN push body -> pixels, end arg as TR_REFRESH
+  TR_SERIAL,    // serial ingest transfer -> pixels, end arg as TR_REFRESH
+  TR_SCREEN,    // screenshot readback + send, end arg = bytes sent
+  TR_COUNT
+};
+
+static const char *const TRACE_NAMES[TR_COUNT] = {
+  "boot", "refresh", "fetch", "tls", "body", "layout", "draw", "touch", "sleep", "push", "serial", "screen",
+};
+
+enum TracePhase : uint8_t { TRACE_INSTANT = 0, TRACE_BEGIN = 1, TRACE_END = 2 };
+
+struct TraceRecord {
+  uint32_t ts;     // esp_timer microseconds, low 32 bits
+  uint32_t arg;
+  uint16_t boot;   // boots since power-on
+  uint8_t  id;
+  uint8_t  flags;  // bits 0-1 phase, bit 7 core
+};
+
+RTC_NOINIT_ATTR static TraceRecord trace_ring[TRACE_EVENTS];
+RTC_NOINIT_ATTR static uint32_t    trace_magic;
+RTC_NOINIT_ATTR static uint32_t    trace_saved_head;  // copy of trace_head that survives a reset
+RTC_NOINIT_ATTR static uint16_t    trace_boot;
+
+static uint32_t trace_head = 0;  // next record number; lives in DRAM where atomics work
+
+static void wcTrace(uint8_t id, uint8_t phase, uint32_t arg = 0) {
+  // Clock before slot, so slot order is time order but for the instant in
+  // between; trace2json.py allows for that much
+  uint32_t ts = (uint32_t)esp_timer_get_time();
+  uint32_t n  = __atomic_fetch_add(&trace_head, 1, __ATOMIC_RELAXED);
+  TraceRecord &r = trace_ring[n & (TRACE_EVENTS - 1)];
+  r.ts    = ts;
+  r.arg   = arg;
+  r.boot  = trace_boot;
+  r.id    = id;
+  r.flags = phase | (xPortGetCoreID() << 7);
+  trace_saved_head = n + 1;  // may lag by one under a race; good enough after a crash
+}
+
+static inline void wcTraceBegin(uint8_t id, uint32_t arg = 0) { wcTrace(id, TRACE_BEGIN, arg); }
+static inline void wcTraceEnd(uint8_t id, uint32_t arg = 0)   { wcTrace(id, TRACE_END, arg); }
+static inline void wcTraceMark(uint8_t id, uint32_t arg = 0)  { wcTrace(id, TRACE_INSTANT, arg); }
+
+// Call first thing in setup(). Keeps the ring across anything but a power-on.
+static void wcTraceInit() {
+  esp_reset_reason_t why = esp_reset_reason();
+  if (trace_magic != TRACE_MAGIC || why == ESP_RST_POWERON || why == ESP_RST_BROWNOUT) {
+    memset(trace_ring, 0, sizeof(trace_ring));
+    trace_magic      = TRACE_MAGIC;
+    trace_saved_head = 0;
+    trace_boot       = 0;
+  } else {
+    trace_boot++;
+    Serial.printf("[Trace] reset reason %d, %u events kept from before the reset\n",
+                  (int)why, (unsigned)min(trace_saved_head, (uint32_t)TRACE_EVENTS));
+  }
+  trace_head = trace_saved_head;
+  wcTraceMark(TR_BOOT, why);
+}
+
+static void wcTraceClear() {
+  trace_head = trace_saved_head = 0;
+  memset(trace_ring, 0, sizeof(trace_ring));
+}
+
+// Text dump for tools/trace2json.py: event names, then one line per record,
+// oldest first
+static void wcTraceDump(Print &out) {
+  uint32_t head = trace_head;
+  uint32_t n    = min(head, (uint32_t)TRACE_EVENTS);
+  out.printf("# trace %u events\n", (unsigned)n);
+  for (int i = 0; i < TR_COUNT; i++) out.printf("N %d %s\n", i, TRACE_NAMES[i]);
+  for (uint32_t k = head - n; k != head; k++) {
+    const TraceRecord &r = trace_ring[k & (TRACE_EVENTS - 1)];
+    out.printf("E %u %u %u %u %u %u\n", r.boot, r.flags >> 7, r.flags & 3, r.id,
+               (unsigned)r.ts, (unsigned)r.arg);
+  }
+  out.println("# end");
+}
@@ -6,26 +6,32 @@
 
 #include <Arduino.h>
 #include <WiFi.h>
-#include <time.h>
 
 #include <Arduino_GFX_Library.h>
 #include <XPT2046_Touchscreen.h>
 #include "Portal.h"
 #include "HTTPS.h"
-
-// Text color palettes
-static const uint16_t TEXT_COLORS[] = {
-  0xFFFF,  // 0 white
-  0x07E0,  // 1 green
-  0x07FF,  // 2 cyan
-  0xFFE0,  // 3 yellow
-  0xFD20,  // 4 orange
-  0xF800,  // 5 red
-};
-static const uint16_t MULTI_COLORS[] = {
-  0x07FF, 0x07E0, 0xFFE0, 0xFD20, 0xF800, 0xF81F, 0xFFFF
-};
-#define MULTI_COLOR_COUNT 7
+#include "Touch.h"
+#include "Anchor.h"
+#include "Ingest.h"
+#include "BusStats.h"
+#include "Power.h"
+#include "DocStore.h"
+#include "Highlight.h"
+#include "Layout.h"
+#include "Trace.h"
+#include "Console.h"
+#include "Glyphs.h"
+#include "Push.h"
+#include "Schedule.h"
+#include "Clock.h"
+#include "Filter.h"
+#include "Dashboard.h"
+#include "SerialIngest.h"
+#include "Theme.h"
+#include "Render.h"
+#include "Screenshot.h"
+#include "Bench.h"
 
 /*******************************************************************************
  * Display setup - CYD (Cheap Yellow Display) proven working config
@@ -33,14 +39,18 @@ static const uint16_t MULTI_COLORS[] = {
  ******************************************************************************/
 #define GFX_BL 21
 
-Arduino_DataBus *bus = new Arduino_HWSPI(
+Arduino_DataBus *hwBus = new Arduino_HWSPI(
     2  /* DC */,
     15 /* CS */,
     14 /* SCK */,
     13 /* MOSI */,
     12 /* MISO */);
 
-Arduino_GFX *gfx = new Arduino_ILI9341(bus, GFX_NOT_DEFINED, 1 /* landscape */);
+// All display traffic goes through the counting bus so we can see what each frame costs
+CountingBus *bus = new CountingBus(hwBus);
+
+Arduino_TFT *tft = new Arduino_ILI9341(bus, GFX_NOT_DEFINED, 1 /* landscape */);
+Arduino_GFX *gfx = tft;  // same panel; tft also exposes raw address-window writes
 
 /*******************************************************************************
  * Touch screen - XPT2046 on separate VSPI bus
@@ -50,26 +60,25 @@ Arduino_GFX *gfx = new Arduino_ILI9341(bus, GFX_NOT_DEFINED, 1 /* landscape */);
 #define XPT2046_MISO 39
 #define XPT2046_CLK  25
 #define XPT2046_CS   33
-#define TOUCH_DEBOUNCE 250
 
 SPIClass touchSPI(VSPI);
 XPT2046_Touchscreen ts(XPT2046_CS, XPT2046_IRQ);
-static unsigned long lastTouchTime = 0;
 /*******************************************************************************
  * End of display setup
  ******************************************************************************/
 
-#define UPDATE_INTERVAL (15UL * 60UL * 1000UL)  // refresh every 15 minutes
 #define BOOT_LONG_MS    800UL                    // hold threshold: long press = re-fetch
 
-// Cached body and pagination state
-static String wc_body       = "";
-static int    wc_page_start = 0;  // char offset of current page
-static int    wc_page_next  = -1; // char offset of next page (-1 = end of content)
+// Documents and their layout state. wc_panes[0] is the main file; in
+// dashboard mode the text area is tiled into wc_pane_count panes.
+static Pane       wc_panes[DASH_MAX_PANES];
+static int        wc_pane_count = 1;
+static LineFilter wc_filter;     // drops uninteresting lines before they are stored
+
+#define TEXT_AREA_Y 20                        // below the status bar
+#define TEXT_AREA_H (gfx->height() - 34)      // above the footer
 
-// Page history stack for going backwards (up to 64 pages)
-static int    wc_page_hist[64];
-static int    wc_hist_size  = 0;
+static bool dashboardMode() { return wc_pane_count > 1; }
 
 // Print a status line in the top bar
 void showStatus(const char *msg) {
@@ -81,182 +90,879 @@ void showStatus(const char *msg) {
   Serial.println(msg);
 }
 
-// Draw UTC timestamp in the bottom-right corner
-void drawTimestamp() {
-  struct tm timeinfo;
-  if (!getLocalTime(&timeinfo)) return;
+static int32_t wc_clock_drawn = -1;  // minute the footer shows
+
+// Draw UTC timestamp in the bottom-right corner. Only touches the panel when
+// the minute has changed, unless force (the page under it was just redrawn).
+void drawTimestamp(bool force = false) {
+  int32_t minute = wcClockMinute();
+  if (minute < 0 || (minute == wc_clock_drawn && !force)) return;
+  wc_clock_drawn = minute;
   char buf[12];
-  strftime(buf, sizeof(buf), "%H:%M UTC", &timeinfo);
+  wcClockFormat(minute, buf, sizeof(buf));
   int tw = strlen(buf) * 6;
   int tx = gfx->width()  - tw - 3;
   int ty = gfx->height() - 10;
   gfx->fillRect(tx - 1, ty - 1, tw + 2, 10, RGB565_BLACK);
-  gfx->setTextColor(0x7BEF);  // gray
+  gfx->setTextColor(wc_theme->gray);
   gfx->setTextSize(1);
   gfx->setCursor(tx, ty);
   gfx->print(buf);
 }
 
-// Render the current page from wc_page_start. Sets wc_page_next (-1 = end).
-void renderPage() {
-  if (wc_body.isEmpty()) return;
+// Page drawing lives in Render.h so host tools can run it; here it draws on
+// the panel behind the counting bus
+void drawRow(const Pane &p, int from, int to, int x, int y, uint16_t color, uint8_t *lex) {
+  wcDrawRow(tft, bus, p, from, to, x, y, color, lex);
+}
+
+int layoutPage(const Pane &p, int start, bool draw, uint8_t &lex) {
+  return wcLayoutPage(tft, bus, p, start, draw, lex);
+}
+
+// ---------------------------------------------------------------------------
+// Table mode (CSV/TSV, see Table.h)
+// ---------------------------------------------------------------------------
 
-  int sz = constrain(wc_text_size, 1, 3);
+// Fit the columns of p's table to the pane at its text size. A column gets
+// its widest cell but at most half the pane; if they still don't all fit
+// they are split into column pages, with the first column on every page.
+void planColumns(Pane &p) {
+  const TableIndex &t = p.table;
+  int avail = max((p.w - 2 * PANE_PAD) / (6 * constrain(p.textSize, 1, 3)), 8);
+  int total = -1;
+  for (int c = 0; c < t.cols; c++) {
+    p.colW[c] = constrain(t.width[c], 1, avail / 2);
+    total += p.colW[c] + 1;
+  }
+  p.colPages.clear();
+  if (total <= avail) {
+    p.colPages.push_back(1);
+  } else {
+    p.colW[0] = min((int)p.colW[0], avail / 3);
+    int room = avail - p.colW[0] - 1;
+    int used = room;  // forces a page break before column 1
+    for (int c = 1; c < t.cols; c++) {
+      p.colW[c] = min((int)p.colW[c], room);
+      if (used + 1 + p.colW[c] > room) {
+        p.colPages.push_back(c);
+        used = p.colW[c];
+      } else {
+        used += 1 + p.colW[c];
+      }
+    }
+  }
+  p.colPage = min(p.colPage, (int)p.colPages.size() - 1);
+}
+
+// Data rows per page; the header row is repeated at the top of every page
+int tableRowsPerPage(const Pane &p) {
+  int lineH = 8 * constrain(p.textSize, 1, 3) + 2;
+  return max((p.h - PANE_PAD) / lineH - 1, 1);
+}
+
+// Page index of a table: the offset of the first data row of every page
+void buildTableIndex(Pane &p) {
+  planColumns(p);
+  int rpp = tableRowsPerPage(p);
+  p.pages.clear();
+  p.pageLex.clear();
+  for (size_t r = 1; r < p.table.rows.size(); r += rpp) {
+    p.pages.push_back(p.table.rows[r]);
+    p.pageLex.push_back(LEXS_CODE);
+  }
+  Serial.printf("[Table] %d pages x %d rows, %d column pages at size %d\n",
+                (int)p.pages.size(), rpp, (int)p.colPages.size(), p.textSize);
+}
+
+// Draw n chars of text as one row in a single color
+void drawText(const Pane &p, char *text, int n, int x, int y, uint16_t color) {
+  static uint16_t colors[GLYPH_MAX_LINE_PX / GLYPHS_X2.W];
+  int sz = constrain(p.textSize, 1, 3);
+  if (sz >= 2 && wc_glyph_blit && n <= (int)(sizeof(colors) / sizeof(colors[0]))) {
+    for (int i = 0; i < n; i++) colors[i] = color;
+    wcDrawGlyphRow(tft, bus, x, y, text, colors, n, sz, RGB565_BLACK);
+    return;
+  }
+  text[n] = '\0';
+  gfx->setCursor(x, y);
+  gfx->setTextColor(color);
+  gfx->print(text);
+}
+
+// Put a cell into w chars at dst: cut with a '~' when too long, numbers
+// right-aligned
+void putCell(char *dst, const char *cell, int len, int w) {
+  if (len > w) {
+    memcpy(dst, cell, w - 1);
+    dst[w - 1] = '~';
+    return;
+  }
+  bool number = len > 0;
+  for (int i = 0; i < len && number; i++) number = strchr("0123456789.,-+%", cell[i]) != nullptr;
+  memcpy(dst + (number ? w - len : 0), cell, len);
+}
+
+// Draw table row r of p at y: the first column, then the current column page
+void drawTableRow(const Pane &p, int r, int y, uint16_t color) {
+  const TableIndex &t = p.table;
+  char line[GLYPH_MAX_LINE_PX / 6 + 1];
+  int  avail = min((p.w - 2 * PANE_PAD) / (6 * constrain(p.textSize, 1, 3)), (int)sizeof(line) - 1);
+  int  first = p.colPages[p.colPage];
+  int  stop  = p.colPage + 1 < (int)p.colPages.size() ? p.colPages[p.colPage + 1] : t.cols;
+  memset(line, ' ', avail);
+
+  char cell[TABLE_CELL_MAX];
+  int  x = 0, pos = t.rows[r];
+  bool last = false;
+  for (int c = 0; c < stop && !last; c++) {
+    int len;
+    pos = wcTableCell(p.body, pos, t.sep, cell, sizeof(cell), len, last);
+    if (c > 0 && c < first) continue;  // on an earlier column page
+    int w = min((int)p.colW[c], avail - x);
+    if (w <= 0) break;
+    putCell(line + x, cell, len, w);
+    x += w + 1;
+  }
+  int n = avail;
+  while (n > 0 && line[n - 1] == ' ') n--;
+  if (n) drawText(p, line, n, p.x + PANE_PAD, y, color);
+}
+
+// Draw the current page of a table pane: header row, then the page's rows
+void drawTablePage(const Pane &p) {
+  int sz    = constrain(p.textSize, 1, 3);
+  int lineH = 8 * sz + 2;
+  int rpp   = tableRowsPerPage(p);
+  int r0    = 1 + p.page * rpp;
+  int y     = p.y + PANE_PAD;
   gfx->setTextSize(sz);
+  gfx->fillRect(p.x, p.y, p.w, p.h, RGB565_BLACK);
 
-  const int lineH   = 8 * sz + 2;
-  const int charW   = 6 * sz;
-  const int maxX    = 4;
-  const int startY  = 24;
-  const int maxY    = gfx->height() - 14;
-  const int maxCols = (gfx->width() - maxX - 4) / charW;
+  drawTableRow(p, 0, y, wc_theme->highlight[LEX_KEY]);
+  for (int i = 0; i < rpp && r0 + i < (int)p.table.rows.size(); i++) {
+    y += lineH;
+    uint16_t color = p.colorIdx == 6 ? wc_theme->multi[i % MULTI_COLOR_COUNT] : wc_theme->text[p.colorIdx];
+    drawTableRow(p, r0 + i, y, color);
+  }
+}
 
-  gfx->fillRect(0, 20, gfx->width(), gfx->height() - 20, RGB565_BLACK);
+// ---------------------------------------------------------------------------
+// Page packs (PagePack.h, tools/pagepack.cpp): laid out on a PC, drawn here
+// by lookup
+// ---------------------------------------------------------------------------
 
-  int y         = startY;
-  int lineStart = wc_page_start;
-  int bodyLen   = wc_body.length();
-  int colorStep = 0;
+// A pack is only used as is in a pane it was built for
+bool packFits(const Pane &p) {
+  const PackInfo &h = p.pack;
+  return h.textSize == p.textSize && h.charW == wcCharW(h.textSize) && h.lineH == wcLineH(h.textSize) &&
+         h.cols == wcLayoutCols(p.w, p.textSize) && h.rows == wcLayoutRows(p.h, p.textSize);
+}
 
-  wc_page_next = -1;  // assume we'll reach the end
+// Replace the pack in p by the text inside it, to be laid out like any other
+// document. The hash stays that of the pack, so a refetch still matches.
+void unpackPane(Pane &p) {
+  const PackInfo &h = p.pack;
+  Serial.printf("[Pack] built for %ux%u at size %u, pane is %dx%d at size %d: laying out its text\n",
+                h.cols, h.rows, h.textSize, wcLayoutCols(p.w, p.textSize), wcLayoutRows(p.h, p.textSize),
+                p.textSize);
+  DocStore text;
+  char buf[256];
+  for (uint32_t at = 0; at < h.textLen;) {
+    uint32_t n = min((uint32_t)sizeof(buf), h.textLen - at);
+    p.body.copy(h.textOff + at, h.textOff + at + n, buf);
+    if (!text.append((const uint8_t *)buf, n)) {
+      Serial.println("[Pack] out of memory, text cut short");
+      break;
+    }
+    at += n;
+  }
+  text.seal();
+  p.body   = std::move(text);
+  p.packed = false;
+  p.lines.build(p.body);
+}
 
-  while (lineStart <= bodyLen) {
-    int savedLineStart = lineStart;
-    int lineEnd = wc_body.indexOf('\n', lineStart);
-    if (lineEnd == -1) lineEnd = bodyLen;
+// The page index is the pack's page table, moved onto body offsets
+void buildPackIndex(Pane &p) {
+  const PackInfo &h = p.pack;
+  p.pages.clear();
+  p.pageLex.assign(h.pages, LEXS_CODE);
+  for (uint32_t pg = 0; pg < h.pages; pg++) {
+    uint32_t row = wcPackPageRow(p.body, h, pg);
+    p.pages.push_back(h.textOff + (row < h.rowCount ? wcPackRow(p.body, h, row).off : h.textLen));
+  }
+  Serial.printf("[Layout] %d pages at size %d (page pack, %u rows%s)\n", (int)p.pages.size(), p.textSize,
+                h.rowCount, h.bitsOff ? ", bitmaps" : "");
+}
 
-    String line = wc_body.substring(lineStart, lineEnd);
-    if (line.endsWith("\r")) line.remove(line.length() - 1);
+void drawPackPage(const Pane &p) {
+  const PackInfo &h = p.pack;
+  static uint8_t bits[PACK_BITS_MAX];
+  gfx->fillRect(p.x, p.y, p.w, p.h, RGB565_BLACK);
+  gfx->setTextSize(h.textSize);
+  uint32_t first = wcPackPageRow(p.body, h, p.page);
+  uint32_t end   = wcPackPageRow(p.body, h, p.page + 1);
+  int cellH  = 8 * h.textSize;
+  int stride = h.bitsRowBytes / cellH;
+  for (uint32_t i = first; i < end; i++) {
+    PackRow r = wcPackRow(p.body, h, i);
+    int x = p.x + PANE_PAD;
+    int y = p.y + PANE_PAD + (i - first) * h.lineH;
+    uint16_t color = r.color & PACK_MULTI ? wc_theme->multi[(r.color & ~PACK_MULTI) % MULTI_COLOR_COUNT]
+                                          : wc_theme->text[min((int)r.color, TEXT_COLOR_COUNT - 1)];
+    if (h.bitsOff && !(r.flags & PACK_ROW_TEXT)) {
+      uint32_t at = h.bitsOff + i * h.bitsRowBytes;
+      p.body.copy(at, at + h.bitsRowBytes, (char *)bits);
+      wcBlitBits(tft, bus, x, y, bits, stride, r.len * h.charW, cellH, color, RGB565_BLACK);
+    } else {
+      drawRow(p, h.textOff + r.off, h.textOff + r.off + r.len, x, y, color, nullptr);
+    }
+  }
+}
 
-    bool pageBreak = false;
-    while (line.length() > 0) {
-      if (y + lineH > maxY) {
-        wc_page_next = savedLineStart;  // resume from start of this line
-        pageBreak = true;
-        break;
-      }
-      String segment;
-      if ((int)line.length() <= maxCols) {
-        segment = line;
-        line    = "";
-      } else {
-        int cut = maxCols;
-        for (int i = maxCols; i > 0; i--) {
-          if (line[i] == ' ') { cut = i; break; }
-        }
-        segment = line.substring(0, cut);
-        line    = line.substring(cut);
-        line.trim();
-      }
-      if (wc_text_color_idx == 6) {
-        gfx->setTextColor(MULTI_COLORS[colorStep % MULTI_COLOR_COUNT]);
-      } else {
-        gfx->setTextColor(TEXT_COLORS[wc_text_color_idx]);
-      }
-      gfx->setCursor(maxX, y);
-      gfx->print(segment);
-      y += lineH;
-      colorStep++;
+// Lay out the whole body of p once (without drawing) and record every page
+// start. Rebuilt whenever the body or the text size changes, unless the page
+// table cache already holds this document at this size.
+void buildPageIndex(Pane &p) {
+  if (p.packed && !packFits(p)) unpackPane(p);
+  if (p.packed) {
+    buildPackIndex(p);
+    return;
+  }
+  if (p.table.sep) {
+    buildTableIndex(p);
+    return;
+  }
+  PageTableCache &cache = p.cache[constrain(p.textSize, 1, 3)];
+  if (cache.valid && memcmp(cache.hash, p.hash, DOC_HASH_LEN) == 0) {
+    p.pages   = cache.pages;
+    p.pageLex = cache.lex;
+    Serial.printf("[Layout] %d pages at size %d (cached)\n", (int)p.pages.size(), p.textSize);
+    return;
+  }
+
+  // One pass over the whole document also checkpoints the highlighter's state
+  // at each page start, so drawing any page later only lexes that page
+  wcTraceBegin(TR_LAYOUT);
+  p.pages.clear();
+  p.pageLex.clear();
+  int     start = 0;
+  uint8_t lex   = LEXS_CODE;
+  while (start != -1) {
+    p.pages.push_back(start);
+    p.pageLex.push_back(lex);
+    int next = layoutPage(p, start, false, lex);
+    if (next != -1 && next <= start) break;  // no forward progress: stop rather than spin
+    start = next;
+  }
+  wcTraceEnd(TR_LAYOUT, p.pages.size());
+  Serial.printf("[Layout] %d lines, %d pages at size %d\n",
+                p.lines.count(), (int)p.pages.size(), p.textSize);
+
+  cache.valid = true;
+  memcpy(cache.hash, p.hash, DOC_HASH_LEN);
+  cache.pages = p.pages;
+  cache.lex   = p.pageLex;
+}
+
+// Where the reader is in p, independent of the current layout
+ReadAnchor currentAnchor(const Pane &p) {
+  return wcCaptureAnchor(p.body, p.lines, p.pages[p.page]);
+}
+
+// Page of p holding a char offset, found by binary search through the page index
+int pageForOffset(const Pane &p, int offset) {
+  return wcFindSlot(p.pages, offset);
+}
+
+// Draw the current page of one pane, touching nothing outside its rectangle
+void drawPane(Pane &p) {
+  if (p.body.isEmpty()) return;
+
+  wcTraceBegin(TR_DRAW, p.page);
+  bus->resetFrame();
+  unsigned long t0 = micros();
+  uint32_t decodes0 = p.body.decodes();
+  uint8_t lex = p.pageLex[p.page];
+  if (p.packed)         drawPackPage(p);
+  else if (p.table.sep) drawTablePage(p);
+  else                  layoutPage(p, p.pages[p.page], true, lex);
+
+  Serial.printf("[Bus] pane %d page %d/%d: %lu us, %u transactions, %u commands, %u px, %u bytes\n",
+                (int)(&p - wc_panes), p.page + 1, (int)p.pages.size(), (unsigned long)(micros() - t0),
+                bus->frame.transactions, bus->frame.commands, bus->frame.pixels, bus->frame.bytes);
+  if (p.body.compressed()) Serial.printf("[Doc] page decoded %u blocks\n", p.body.decodes() - decodes0);
+  wcTraceEnd(TR_DRAW, p.page);
+}
+
+// Redraw the whole screen below the status bar: every pane, the rules
+// between dashboard panes, and the footer
+void renderPage() {
+  bool any = false;
+  for (int i = 0; i < wc_pane_count; i++) {
+    if (wc_panes[i].body.isEmpty()) continue;
+    drawPane(wc_panes[i]);
+    any = true;
+  }
+  if (!any) return;
+
+  if (dashboardMode()) {
+    for (int i = 0; i < wc_pane_count; i++) {
+      const Pane &p = wc_panes[i];
+      if (p.body.isEmpty()) gfx->fillRect(p.x, p.y, p.w, p.h, RGB565_BLACK);
+      // rule along the right and bottom edges that border another pane
+      if (p.x + p.w + PANE_GAP < gfx->width())
+        gfx->drawFastVLine(p.x + p.w + PANE_GAP / 2, p.y, p.h, wc_theme->rule);
+      if (p.y + p.h + PANE_GAP < TEXT_AREA_Y + TEXT_AREA_H)
+        gfx->drawFastHLine(p.x, p.y + p.h + PANE_GAP / 2, p.w, wc_theme->rule);
     }
-    if (pageBreak) break;
-    lineStart = lineEnd + 1;
   }
 
   // Bottom-left hint
+  const Pane &first = wc_panes[0];
+  gfx->fillRect(0, gfx->height() - 14, gfx->width(), 14, RGB565_BLACK);
   gfx->setTextSize(1);
-  gfx->setTextColor(0x7BEF);  // gray
+  gfx->setTextColor(wc_theme->gray);
   gfx->setCursor(4, gfx->height() - 10);
-  if (wc_page_next == -1) {
+  if (dashboardMode()) {
+    gfx->print("tap pane = next page  hold=refetch");
+  } else if (first.page + 1 >= (int)first.pages.size()) {
     gfx->print("< prev   restart >   hold=refetch");
   } else {
     gfx->print("< prev     next >    hold=refetch");
   }
-  drawTimestamp();
+  drawTimestamp(true);
+  wcPowerFrameDrawn();
 }
 
-// Fetch content and render first page. Returns true on success.
-bool fetchAndRender() {
-  if (strlen(wc_raw_url) == 0) {
-    showStatus("No URL set - hold BOOT to configure");
-    return false;
+// Show a change to pane p: the full screen in single-file mode, only the
+// pane's own rectangle on a dashboard
+void refreshPane(Pane &p) {
+  if (!dashboardMode()) {
+    renderPage();
+    return;
   }
-  String body = https_get_string(String(wc_raw_url));
-  if (body.isEmpty()) return false;
-  wc_body       = body;
-  wc_page_start = 0;
+  drawPane(p);
+  wcPowerFrameDrawn();
+}
+
+#ifdef GLYPH_BENCH
+// Draw the first page at every text size, once through Arduino_GFX and once
+// through the pre-scaled glyph tables, and log what each cost on the bus
+void benchGlyphs() {
+  Pane &p = wc_panes[0];
+  int savedSize = p.textSize;
+  for (int sz = 1; sz <= 3; sz++) {
+    p.textSize = sz;
+    for (int blit = 0; blit <= 1; blit++) {
+      wc_glyph_blit = blit;
+      uint8_t lex = LEXS_CODE;
+      bus->resetFrame();
+      unsigned long t0 = micros();
+      layoutPage(p, 0, true, lex);
+      unsigned long us = micros() - t0;
+      Serial.printf("[Glyph] size %d %-4s: %7lu us, %6u transactions, %7u commands, %7u bytes\n",
+                    sz, blit ? "blit" : "gfx", us,
+                    bus->frame.transactions, bus->frame.commands, bus->frame.bytes);
+    }
+  }
+  wc_glyph_blit = true;
+  p.textSize    = savedSize;
   renderPage();
+}
+#endif
+
+// Put a finished document (downloaded or pushed) into pane p. A refresh keeps
+// the reader on the same text rather than jumping back to page 1, and a
+// byte-identical one leaves the layout, page index and screen untouched.
+// Returns false in that case.
+bool showDocument(Pane &p, IngestSink &sink, const char *tag) {
+  bool hadBody = !p.body.isEmpty();
+  if (hadBody && memcmp(sink.hash, p.hash, DOC_HASH_LEN) == 0) {
+    Serial.printf("[%s] unchanged (sha256 %s), %d bytes\n",
+                  tag, wcHashHex(sink.hash).c_str(), sink.body.length());
+    return false;
+  }
+  Serial.printf("[%s] new content (sha256 %s), %d bytes in %d chunks (%d in RAM), heap free %u, largest block %u\n",
+                tag, wcHashHex(sink.hash).c_str(), sink.body.length(), sink.body.chunks(), sink.body.heapBytes(),
+                ESP.getFreeHeap(), ESP.getMaxAllocHeap());
+
+  PackInfo   pack;
+  PackStatus packStatus = wcPackCheck(sink.body, pack);
+  if (packStatus > PACK_OK) {
+    Serial.printf("[%s] page pack rejected: %s\n", tag, wcPackError(packStatus));
+    showStatus("Page pack rejected (see serial log)");
+    return false;
+  }
+
+  ReadAnchor anchor = hadBody ? currentAnchor(p) : ReadAnchor{0, 0, 0};
+  p.body = std::move(sink.body);  // a flash-mapped body unmaps the slot it replaces
+  if (sink.flashSlot() >= 0) doc_flash_slot = sink.flashSlot();
+  memcpy(p.hash, sink.hash, DOC_HASH_LEN);
+  p.table = std::move(sink.table.idx);
+  p.packed = packStatus == PACK_OK;
+  p.pack   = pack;
+  if (p.packed) p.table = TableIndex();
+  p.lines.build(p.body);
+  buildPageIndex(p);
+  p.page = hadBody ? pageForOffset(p, wcResolveAnchor(p.body, p.lines, anchor)) : 0;
+  // the first document on a dashboard also needs the rules and footer
+  if (hadBody) refreshPane(p);
+  else         renderPage();
+#ifdef GLYPH_BENCH
+  if (!hadBody && &p == wc_panes) benchGlyphs();
+#endif
   return true;
 }
 
-// Navigate to the next page (or wrap to start at end)
-void goNextPage() {
-  if (wc_body.isEmpty()) return;
-  if (wc_page_next == -1) {
-    // At end — wrap to start and clear history
-    wc_hist_size  = 0;
-    wc_page_start = 0;
-  } else {
-    // Push current position to history, advance
-    if (wc_hist_size < 64) wc_page_hist[wc_hist_size++] = wc_page_start;
-    wc_page_start = wc_page_next;
+// Pushed documents (LAN or serial) always go to the main pane. The pane no
+// longer shows what its URL served, so the next poll must not get a 304.
+bool showPushed(IngestSink &sink, const char *tag) {
+  wc_panes[0].etag = "";
+  return showDocument(wc_panes[0], sink, tag);
+}
+
+// Fetch one pane's feed and show it
+PollResult fetchPane(Pane &p) {
+  if (strlen(p.url) == 0) return POLL_FAILED;
+  wcTraceBegin(TR_REFRESH);
+  // The filter sits in front of the sink, so the hash and the unchanged
+  // check only see the lines that are kept. Only the main pane's document
+  // goes to flash; the slots hold one document.
+  IngestSink sink(&p == wc_panes);
+  sink.table.begin(wcTableSepForUrl(p.url));
+  bool filtered = wc_filter.active();
+  if (filtered) wc_filter.begin(sink);
+  bool ok = https_fetch(String(p.url), filtered ? (Stream &)wc_filter : sink, p.etag.c_str());
+  if (ok && https_stats.code == HTTP_CODE_NOT_MODIFIED) {
+    Serial.println("[Fetch] not modified (ETag)");
+    wcTraceEnd(TR_REFRESH, POLL_UNCHANGED);
+    return POLL_UNCHANGED;
   }
-  renderPage();
-  showStatus(wc_raw_url);
+  if (filtered && ok) ok = wc_filter.finish();
+  if (filtered && ok && sink.length() == 0) sink.print("(no lines match the filter)\n");
+  if (!ok || sink.length() == 0 || !sink.finish()) {
+    wcTraceEnd(TR_REFRESH, POLL_FAILED);
+    return POLL_FAILED;
+  }
+  PollResult r = showDocument(p, sink, "Fetch") ? POLL_CHANGED : POLL_UNCHANGED;
+  p.etag = https_stats.etag;  // only once the body is safely in
+  wcTraceEnd(TR_REFRESH, r);
+  return r;
+}
+
+// Fetch every pane's feed. One schedule covers them all: new content in any
+// pane counts as a change, and the fetch only counts as failed if every
+// pane failed.
+PollResult fetchAndRender() {
+  if (strlen(wc_raw_url) == 0) {
+    showStatus("No URL set - hold BOOT to configure");
+    return POLL_FAILED;
+  }
+  PollResult r = POLL_FAILED;
+  for (int i = 0; i < wc_pane_count; i++) {
+    PollResult pr = fetchPane(wc_panes[i]);
+    if (pr > r) r = pr;
+  }
+  return r;
+}
+
+// Navigate to the next page (or wrap to start at end)
+void goNextPage(Pane &p) {
+  if (p.body.isEmpty()) return;
+  p.page = p.page + 1 < (int)p.pages.size() ? p.page + 1 : 0;
+  refreshPane(p);
+  showStatus(p.url);
 }
 
 // Navigate to the previous page
-void goPrevPage() {
-  if (wc_body.isEmpty() || wc_hist_size == 0) return;  // already on first page
-  wc_page_start = wc_page_hist[--wc_hist_size];
-  renderPage();
-  showStatus(wc_raw_url);
+void goPrevPage(Pane &p) {
+  if (p.body.isEmpty() || p.page == 0) return;  // already on first page
+  p.page--;
+  refreshPane(p);
+  showStatus(p.url);
+}
+
+// Jump forward n pages (stops on the last page)
+void skipForward(Pane &p, int n) {
+  if (p.body.isEmpty() || p.page + 1 >= (int)p.pages.size()) return;
+  p.page = min(p.page + n, (int)p.pages.size() - 1);
+  refreshPane(p);
+  showStatus(p.url);
+}
+
+// Jump back n pages (stops on the first page)
+void skipBack(Pane &p, int n) {
+  if (p.body.isEmpty() || p.page == 0) return;
+  p.page = max(p.page - n, 0);
+  refreshPane(p);
+  showStatus(p.url);
+}
+
+// Show the next (d = 1) or previous (d = -1) set of columns of a table.
+// False when p isn't a table that needs column pages.
+bool shiftColumns(Pane &p, int d) {
+  if (!p.table.sep || p.colPages.size() < 2) return false;
+  int cp = constrain(p.colPage + d, 0, (int)p.colPages.size() - 1);
+  if (cp != p.colPage) {
+    p.colPage = cp;
+    refreshPane(p);
+  }
+  int last = cp + 1 < (int)p.colPages.size() ? p.colPages[cp + 1] - 1 : p.table.cols - 1;
+  char msg[48];
+  snprintf(msg, sizeof(msg), "Columns %d-%d of %d", p.colPages[cp] + 1, last + 1, p.table.cols);
+  showStatus(msg);
+  return true;
+}
+
+// Step the text size of p by delta, re-paginate and stay on the same text
+void changeTextSize(Pane &p, int delta) {
+  int sz = constrain(p.textSize + delta, 1, 3);
+  if (sz == p.textSize) return;
+  int idx = &p - wc_panes;
+  if (idx == 0) wcSaveTextSize(sz);
+  else          wcSavePaneTextSize(idx - 1, sz);
+  if (p.body.isEmpty()) {
+    p.textSize = sz;
+    return;
+  }
+  ReadAnchor anchor = currentAnchor(p);
+  p.textSize = sz;
+  buildPageIndex(p);
+  p.page = pageForOffset(p, wcResolveAnchor(p.body, p.lines, anchor));
+  refreshPane(p);
+  showStatus(p.url);
 }
 
-// Check for touch input and handle left/right tap navigation
+// Set up the panes from the settings: one covering the text area, or the
+// dashboard tiling with a feed per pane
+void setupPanes() {
+  int layout = wc_dash_layout;
+  for (int i = 1; i < DASH_PANE_COUNT[constrain(layout, 0, DASH_LAYOUT_COUNT - 1)]; i++) {
+    if (!wc_dash_url[i - 1][0]) {
+      Serial.printf("[Dash] pane %d has no URL, showing the main file only\n", i + 1);
+      layout = 0;
+    }
+  }
+  wc_pane_count = wcDashPlace(layout, wc_panes, 0, TEXT_AREA_Y, gfx->width(), TEXT_AREA_H);
+  for (int i = 0; i < wc_pane_count; i++) {
+    Pane &p = wc_panes[i];
+    p.url      = i == 0 ? wc_raw_url        : wc_dash_url[i - 1];
+    p.textSize = i == 0 ? wc_text_size      : wc_dash_size[i - 1];
+    p.colorIdx = i == 0 ? wc_text_color_idx : wc_dash_color[i - 1];
+    p.lexRules = wcLexRulesForUrl(p.url);
+    if (p.lexRules) Serial.printf("[Highlight] pane %d: %s lexer\n", i + 1, p.lexRules->name);
+  }
+  if (dashboardMode()) Serial.printf("[Dash] layout %d, %d panes\n", layout, wc_pane_count);
+}
+
+// Check for touch input and dispatch gestures to the pane they started in:
+//   tap right/left half = next/prev (on a dashboard any tap = next), swipe =
+//   next/prev (columns, on a table too wide for the pane), fling = multi-page
+//   skip, swipe up/down = larger/smaller text, long press = re-fetch
 void handleTouch() {
-  if (ts.tirqTouched() && ts.touched()) {
-    if (millis() - lastTouchTime > TOUCH_DEBOUNCE) {
-      lastTouchTime = millis();
-      TS_Point p = ts.getPoint();
-      int x = map(p.x, 200, 3700, 0, gfx->width());
-      if (x >= gfx->width() / 2) {
-        goNextPage();   // right half = next
-      } else {
-        goPrevPage();   // left half = prev
+  TouchGesture g;
+  if (!wcTouchPoll(g)) return;
+  wcTraceMark(TR_TOUCH, g.type);
+  if (wcPowerActivity()) return;  // first touch on a dark screen only lights it
+
+  int   idx = wcDashPaneAt(wc_panes, wc_pane_count, g.x, g.y);
+  Pane &p   = wc_panes[idx < 0 ? 0 : idx];
+  unsigned long t0 = micros();
+  switch (g.type) {
+    case GESTURE_TAP:
+      if (dashboardMode() || g.x >= gfx->width() / 2) goNextPage(p);
+      else                                            goPrevPage(p);
+      break;
+    case GESTURE_SWIPE_LEFT:  if (!shiftColumns(p, +1)) goNextPage(p); break;
+    case GESTURE_SWIPE_RIGHT: if (!shiftColumns(p, -1)) goPrevPage(p); break;
+    case GESTURE_FLING_LEFT:  skipForward(p, g.pages); break;
+    case GESTURE_FLING_RIGHT: skipBack(p, g.pages);    break;
+    case GESTURE_SWIPE_UP:    changeTextSize(p, +1);   break;
+    case GESTURE_SWIPE_DOWN:  changeTextSize(p, -1);   break;
+    case GESTURE_LONG_PRESS:  wcPollNow();          break;  // re-fetch, keep the reading position
+    default:
+      break;
+  }
+  Serial.printf("[Touch] gesture %d dx=%d dy=%d v=%d,%d pages=%d latency=%luus (avg %luus max %luus) render=%luus\n",
+                g.type, g.dx, g.dy, g.vx, g.vy, g.pages,
+                (unsigned long)g.latencyUs,
+                (unsigned long)(wc_touch_lat_sum / wc_touch_lat_n),
+                (unsigned long)wc_touch_lat_max,
+                (unsigned long)(micros() - t0));
+}
+
+// ---------------------------------------------------------------------------
+// Serial console commands
+// ---------------------------------------------------------------------------
+void cmdHelp(const char *args);
+bool ensureWifi();
+
+void cmdTrace(const char *args) {
+  if (strcmp(args, "clear") == 0) {
+    wcTraceClear();
+    Serial.println("[Trace] cleared");
+  } else {
+    wcTraceDump(Serial);
+  }
+}
+
+void cmdRefetch(const char *args) {
+  wcPollNow();
+}
+
+// Fetch any URL into the main pane once and report how it went on one line
+// (tools/fetchbench.py). No filter and no ETag: the whole pipeline runs.
+// The next poll puts the configured file back.
+void cmdFetch(const char *args) {
+  if (!*args) {
+    Serial.println("#FETCH usage: fetch <url>");
+    return;
+  }
+  if (!ensureWifi()) {
+    Serial.println("#FETCH ok=0 code=0 err=wifi");
+    return;
+  }
+  IngestSink sink;
+  sink.table.begin(wcTableSepForUrl(args));
+  bool ok = https_fetch(String(args), sink) && sink.length() > 0 && sink.finish();
+  uint32_t t0 = millis();
+  if (ok) showPushed(sink, "Fetch");
+  uint32_t renderMs = millis() - t0;
+  const FetchStats &st = https_stats;
+  Serial.printf("#FETCH ok=%d code=%d bytes=%d size=%d connect_ms=%lu tls_heap=%u suite=%s ttfb_ms=%lu "
+                "total_ms=%lu render_ms=%lu first_page_ms=%lu\n",
+                ok, st.code, st.bytes, st.size, (unsigned long)st.connectMs, st.tlsHeap, st.suite,
+                (unsigned long)st.firstByteMs,
+                (unsigned long)st.totalMs, (unsigned long)(ok ? renderMs : 0),
+                (unsigned long)(ok ? st.totalMs + renderMs : 0));
+}
+
+// Load a document over this serial link (SerialIngest.h, tools/serial_send.py)
+void cmdIngest(const char *args) {
+  uint32_t baud = *args ? strtoul(args, nullptr, 10) : SERIAL_BAUD;
+  if (wcSerialIngest(baud, showPushed)) showStatus("Loaded over serial");
+}
+
+// ---------------------------------------------------------------------------
+// Self-benchmark (Bench.h)
+// ---------------------------------------------------------------------------
+
+// Run the suite, reporting to log. The fetch stage gets url, or the
+// configured file when it's empty. Takes over the screen while it runs.
+void runBench(BenchLog &log, const char *url) {
+  uint32_t t0 = millis();
+  char fw[24];
+  snprintf(fw, sizeof(fw), "%s_%s", __DATE__, __TIME__);
+  for (char *c = fw; *c; c++) {
+    if (*c == ' ') *c = '_';
+  }
+  log.result("begin", "fw=%s sdk=%s cpu_mhz=%u compress=%d flash=%d", fw, ESP.getSdkVersion(),
+             (unsigned)getCpuFrequencyMhz(), DOC_COMPRESS, DOC_FLASH);
+
+  // A single-file pane of the fixed test document, whatever the dashboard shows
+  Pane *bp = new Pane;
+  bp->x = 0;
+  bp->y = TEXT_AREA_Y;
+  bp->w = gfx->width();
+  bp->h = TEXT_AREA_H;
+  uint32_t us0 = micros();
+  wcBenchText(bp->body);
+  int bytes = bp->body.length();
+  log.result("doc", "bytes=%d chunks=%d ram=%d us=%lu", bytes, bp->body.chunks(), bp->body.heapBytes(),
+             (unsigned long)(micros() - us0));
+
+  // Layout: the page index pass, plain and with C highlighting
+  for (int sz = 1; sz <= 3; sz++) {
+    bp->textSize = sz;
+    for (int hl = 0; hl <= 1; hl++) {
+      bp->lexRules = hl ? &LEX_C : nullptr;
+      uint8_t lex   = LEXS_CODE;
+      int     pages = 0;
+      us0 = micros();
+      for (int start = 0; start != -1; pages++) {
+        int next = layoutPage(*bp, start, false, lex);
+        if (next != -1 && next <= start) break;
+        start = next;
+      }
+      uint32_t us = max(micros() - us0, 1UL);
+      log.result("layout", "size=%d lex=%d pages=%d us=%lu kb_s=%lu", sz, hl, pages, (unsigned long)us,
+                 (unsigned long)((uint64_t)bytes * 1000000 / 1024 / us));
+    }
+  }
+
+  // Full-page draw of the first page, averaged
+  bp->lexRules = nullptr;
+  for (int sz = 1; sz <= 3; sz++) {
+    bp->textSize = sz;
+    uint32_t us = 0;
+    for (int r = 0; r < BENCH_REPEAT; r++) {
+      uint8_t lex = LEXS_CODE;
+      bus->resetFrame();
+      us0 = micros();
+      layoutPage(*bp, 0, true, lex);
+      us += micros() - us0;
+    }
+    log.result("draw", "size=%d us=%lu transactions=%u bytes=%u", sz, (unsigned long)(us / BENCH_REPEAT),
+               bus->frame.transactions, bus->frame.bytes);
+  }
+  delete bp;
+
+  // Full-screen clear: raw bus throughput
+  int px = gfx->width() * gfx->height();
+  us0 = micros();
+  for (int r = 0; r < BENCH_REPEAT; r++) gfx->fillRect(0, 0, gfx->width(), gfx->height(), RGB565_BLACK);
+  uint32_t clearUs = max((micros() - us0) / BENCH_REPEAT, 1UL);
+  log.result("clear", "px=%d us=%lu mbit_s=%lu", px, (unsigned long)clearUs,
+             (unsigned long)((uint64_t)px * 16 / clearUs));
+
+  // Touch: the library re-reads the XPT2046 at most every 3 ms, so time
+  // reads spaced wider than that; the rate is what the controller sustains
+  uint32_t touchUs = 0;
+  int      reads   = 0;
+  for (uint32_t end = millis() + BENCH_TOUCH_MS; (int32_t)(millis() - end) < 0; reads++) {
+    us0 = micros();
+    ts.getPoint();
+    touchUs += micros() - us0;
+    delay(4);
+  }
+  touchUs = max(touchUs / max(reads, 1), (uint32_t)1);
+  log.result("touch", "reads=%d us=%lu max_per_s=%lu", reads, (unsigned long)touchUs,
+             (unsigned long)(1000000 / touchUs));
+
+  // TLS handshakes to the fetch host: checked against TrustStore.h, and
+  // unchecked as the firmware used to connect, for comparison
+  const char *src = *url ? url : wc_panes[0].url;
+  bool online = *src && ensureWifi();
+  for (int verify = 1; verify >= 0 && online; verify--) {
+    uint32_t ms = 0, session = 0, peak = 0;
+    const char *suite = "-";
+    int ok = 0;
+    for (int r = 0; r < BENCH_TLS_REPEAT; r++) {
+      HeapWatch watch;
+      watch.start();
+      uint32_t t = https_handshake(String(src), verify, session, suite);
+      peak = max(peak, watch.stop());
+      if (t) {
+        ms += t;
+        ok++;
       }
     }
+    log.result("tls", "verify=%d ok=%d suite=%s handshake_ms=%lu session_heap=%u peak_heap=%u", verify, ok,
+               suite, (unsigned long)(ok ? ms / ok : 0), session, peak);
   }
+
+  // Fetch into RAM; nothing is shown
+  if (online) {
+    IngestSink *sink = new IngestSink(false);
+    bool ok = https_fetch(String(src), *sink) && sink->length() > 0 && sink->finish();
+    const FetchStats &st = https_stats;
+    log.result("fetch", "ok=%d code=%d bytes=%d connect_ms=%lu ttfb_ms=%lu total_ms=%lu kb_s=%lu", ok, st.code,
+               st.bytes, (unsigned long)st.connectMs, (unsigned long)st.firstByteMs, (unsigned long)st.totalMs,
+               (unsigned long)(st.totalMs ? (uint64_t)st.bytes * 1000 / 1024 / st.totalMs : 0));
+    delete sink;
+  } else {
+    log.result("fetch", "ok=0 skipped=1");
+  }
+  log.result("end", "total_ms=%lu", (unsigned long)(millis() - t0));
+
+  gfx->fillScreen(RGB565_BLACK);
+  showStatus("Benchmark done");
+  renderPage();
+}
+
+void cmdBench(const char *args) {
+  BenchLog log;
+  runBench(log, args);
+}
+
+// GET /bench[?url=...] on the push server: the same lines as the reply
+void sendBench(WebServer &server) {
+  String out;
+  BenchLog log(&out);
+  runBench(log, server.arg("url").c_str());
+  server.send(200, "text/plain", out);
+}
+
+static const ConsoleCommand CONSOLE_COMMANDS[] = {
+  { "help",    "list commands",                                  cmdHelp },
+  { "trace",   "dump the event trace; 'trace clear' empties it", cmdTrace },
+  { "refetch", "fetch the file now",                             cmdRefetch },
+  { "fetch",   "fetch a URL once and report timings (fetchbench.py)", cmdFetch },
+  { "ingest",  "receive a document: 'ingest [baud]' (serial_send.py)", cmdIngest },
+  { "bench",   "run the self-benchmark: 'bench [url]' (benchcmp.py)", cmdBench },
+};
+#define CONSOLE_COMMAND_COUNT (int)(sizeof(CONSOLE_COMMANDS) / sizeof(CONSOLE_COMMANDS[0]))
+
+void cmdHelp(const char *args) {
+  wcConsoleHelp(CONSOLE_COMMANDS, CONSOLE_COMMAND_COUNT);
+}
+
+// GET /screen on the push server (Push.h, Screenshot.h)
+void sendScreenshot(WebServer &server) {
+  // The touch controller's SPIClass drives the same peripheral and routed its
+  // MISO input to its own pin; point it at the panel for the readback
+  spiAttachMISO(SPI.bus(), 12);
+  wcScreenshot(server, bus, 15, 2, gfx->width(), gfx->height(), wc_theme->invert);
+  spiAttachMISO(touchSPI.bus(), XPT2046_MISO);
+}
+
+static const PushRoute PUSH_ROUTES[] = {
+  { "/screen", sendScreenshot },
+  { "/bench",  sendBench },
+};
+#define PUSH_ROUTE_COUNT (int)(sizeof(PUSH_ROUTES) / sizeof(PUSH_ROUTES[0]))
+
+// Switch to the theme from the settings (Theme.h)
+void applyTheme() {
+  wcThemeSelect(wc_theme_idx);
+  gfx->invertDisplay(wc_theme->invert);
 }
 
 void setup() {
-  Serial.begin(115200);
+  Serial.setRxBufferSize(SERIAL_RX_BUFFER);  // a whole serial ingest window
+  Serial.begin(SERIAL_BAUD);
+  wcTraceInit();
   Serial.println("GithubRaw - GitHub Raw Text Viewer (CYD)");
 
   if (!gfx->begin()) Serial.println("gfx->begin() failed!");
   gfx->fillScreen(RGB565_BLACK);
 
-  pinMode(GFX_BL, OUTPUT);
-  digitalWrite(GFX_BL, HIGH);
+  wcPowerBegin(GFX_BL, XPT2046_IRQ, 0);  // backlight on LEDC, full brightness
 
   // Init touch screen on VSPI
   touchSPI.begin(XPT2046_CLK, XPT2046_MISO, XPT2046_MOSI, XPT2046_CS);
   ts.begin(touchSPI);
   ts.setRotation(1);
+  wcLoadTouchCal();
 
   pinMode(0, INPUT_PULLUP);  // BOOT button
 
   wcLoadSettings();
+  applyTheme();
+  if (DOC_FLASH) wcDocFlashBegin();
+  wc_filter.configure(wc_filter_include, wc_filter_exclude, wc_filter_last, wc_filter_dedupe);
+  setupPanes();
 
   bool showPortal = !wc_has_settings;
+  bool calibrate  = false;
 
   if (!showPortal) {
-    showStatus("Hold BOOT to change settings...");
-    for (int i = 0; i < 30 && !showPortal; i++) {
+    showStatus("Hold BOOT for setup, touch screen to calibrate");
+    for (int i = 0; i < 30 && !showPortal && !calibrate; i++) {
       if (digitalRead(0) == LOW) showPortal = true;
+      if (ts.touched())          calibrate  = true;
       delay(100);
     }
   }
 
+  if (calibrate) {
+    while (ts.touched()) delay(10);
+    if (!wcTouchCalibrate()) wcLoadTouchCal();  // keep the old values on failure
+    gfx->fillScreen(RGB565_BLACK);
+  }
+
   if (showPortal) {
     wcInitPortal();
     while (!portalDone) {
@@ -264,6 +970,7 @@ void setup() {
       delay(5);
     }
     wcClosePortal();
+    applyTheme();  // the portal may have changed it
   }
 
   gfx->fillScreen(RGB565_BLACK);
@@ -274,10 +981,13 @@ void setup() {
   unsigned long wifiStart = millis();
   while (WiFi.status() != WL_CONNECTED) {
     if (millis() - wifiStart > 30000) {
+      // carry on offline: the poll retries with backoff, and a document can
+      // still come in over serial (ingest)
       char errMsg[60];
       snprintf(errMsg, sizeof(errMsg), "WiFi failed: \"%s\"", wc_wifi_ssid);
       showStatus(errMsg);
-      while (true) delay(1000);
+      Serial.println("[WiFi] not connected, serial ingest still available");
+      break;
     }
     delay(500);
     char msg[48];
@@ -285,17 +995,33 @@ void setup() {
     showStatus(msg);
     dots++;
   }
-  showStatus("WiFi connected!");
-  configTime(0, 0, "pool.ntp.org", "time.nist.gov");
-  delay(600);
+  if (WiFi.status() == WL_CONNECTED) showStatus("WiFi connected!");
+  if (wcPushBegin(showPushed, PUSH_ROUTES, PUSH_ROUTE_COUNT) && wc_power_mode == POWER_SLEEP) {
+    // light sleep would drop incoming connections; keep the backlight dimming
+    Serial.println("[Push] push server on, using dim mode instead of light sleep");
+    wc_power_mode = POWER_DIM;
+  }
+  if (wc_power_mode == POWER_SLEEP) WiFi.setSleep(true);  // modem sleep between DTIM beacons
+  wcClockBegin();
 }
 
-unsigned long last_update = 0;
-unsigned long last_clock  = 0;
-#define CLOCK_INTERVAL (60UL * 1000UL)
+// Light sleep can outlast the AP's patience; reconnect before fetching if we were dropped
+bool ensureWifi() {
+  if (WiFi.status() == WL_CONNECTED) return true;
+  showStatus("Reconnecting WiFi...");
+  WiFi.reconnect();
+  unsigned long start = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - start > 15000) return false;
+    delay(100);
+  }
+  return true;
+}
 
 void loop() {
-  handleTouch();  // tap right=next, tap left=prev
+  handleTouch();  // tap/swipe/fling navigation, long press = re-fetch
+  wcConsolePoll(CONSOLE_COMMANDS, CONSOLE_COMMAND_COUNT);
+  if (wcPushPoll()) wcPollNow();  // LAN client asked for a refetch
 
   // BOOT button: short press = next page, long press (hold) = re-fetch
   if (digitalRead(0) == LOW) {
@@ -304,35 +1030,35 @@ void loop() {
       unsigned long pressStart = millis();
       while (digitalRead(0) == LOW) delay(10);
       unsigned long held = millis() - pressStart;
+      bool wasDark = wcPowerActivity();
 
       if (held >= BOOT_LONG_MS) {
-        // Long press — force re-fetch from page 1
-        wc_body       = "";
-        wc_page_start = 0;
-        wc_hist_size  = 0;
-        last_update   = 0;
-      } else {
-        goNextPage();  // short press = next page
+        // Long press — force re-fetch; the reading anchor keeps our place
+        wcPollNow();
+      } else if (!wasDark) {
+        goNextPage(wc_panes[0]);  // short press = next page
       }
     }
   }
 
-  if ((last_update == 0) || (millis() - last_update > UPDATE_INTERVAL)) {
+  if (wcPollDue()) {
     showStatus("Fetching...");
-    if (fetchAndRender()) {
-      wc_hist_size = 0;  // new content resets page history
+    PollResult r = ensureWifi() ? fetchAndRender() : POLL_FAILED;
+    wcPollResult(r);
+    if (r != POLL_FAILED) {
       showStatus(wc_raw_url);
-      last_update = millis();
     } else {
-      showStatus("Fetch failed - retrying in 60s");
-      last_update = millis() - UPDATE_INTERVAL + 60000;
+      char msg[40];
+      snprintf(msg, sizeof(msg), "Fetch failed - retrying in %s", wcPollFmt(wcPollWait()).c_str());
+      showStatus(msg);
     }
   }
 
-  if (last_update != 0 && millis() - last_clock > CLOCK_INTERVAL) {
-    drawTimestamp();
-    last_clock = millis();
-  }
+  if (!wc_panes[0].body.isEmpty()) drawTimestamp();  // no-op until the minute changes
 
-  delay(50);
+  // Sleep (or just wait, depending on the power mode) until the next refresh
+  // or clock tick; touch and BOOT wake us early
+  unsigned long untilFetch = wcPollWait();
+  unsigned long untilClock = wcClockWait();
+  wcPowerIdle(min(untilFetch, untilClock));
 }
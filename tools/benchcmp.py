@@ -0,0 +1,130 @@
+#!/usr/bin/env python3
+"""Run the display's self-benchmark and compare runs between firmware builds.
+
+    python3 tools/benchcmp.py --serial /dev/ttyUSB0 -o before.txt
+    python3 tools/benchcmp.py --url http://192.168.1.50/bench --token SECRET -o after.txt
+    python3 tools/benchcmp.py before.txt after.txt
+
+The first two run the suite (`bench` at the serial console, or GET /bench
+on the push server) and save its #BENCH lines; see include/Bench.h. The
+third lines two saved runs up measurement by measurement and prints the
+change, marking with ! anything more than --threshold percent worse.
+A saved serial log works as input too: only the #BENCH lines are read.
+Run both builds on the same board, and for the fetch stage against the
+same URL (--fetch-url, e.g. tools/rawserver.py on this machine).
+"""
+import argparse
+import sys
+import time
+import urllib.parse
+import urllib.request
+
+ID_KEYS = ("size", "lex", "verify")                     # identify a line within its stage
+INFO_KEYS = ("fw", "sdk", "cpu_mhz", "compress", "flash", "ok", "code", "skipped", "bytes", "pages", "px", "suite",
+             "chunks", "reads", "transactions")
+HIGHER_BETTER = ("kb_s", "mbit_s", "max_per_s", "heap", "maxblk")
+
+
+def parse(lines):
+    """#BENCH lines -> {(stage, ids): {key: value}}, in order."""
+    runs = {}
+    for line in lines:
+        line = line.strip()
+        if not line.startswith("#BENCH "):
+            continue
+        parts = line.split()
+        fields = dict(p.split("=", 1) for p in parts[2:] if "=" in p)
+        ident = (parts[1],) + tuple("%s=%s" % (k, fields[k]) for k in ID_KEYS if k in fields)
+        runs[ident] = fields
+    return runs
+
+
+def capture_serial(port, fetch_url, timeout=120):
+    import serial
+    ser = serial.Serial(port, 115200, timeout=0.2)
+    ser.reset_input_buffer()
+    ser.write(b"\n")  # wakes a device in light sleep
+    time.sleep(0.1)
+    ser.write(b"bench %s\n" % (fetch_url or "").encode())
+    out, buf, end = [], b"", time.monotonic() + timeout
+    while time.monotonic() < end:
+        buf += ser.read(max(1, ser.in_waiting))
+        while b"\n" in buf:
+            line, buf = buf.split(b"\n", 1)
+            text = line.decode("utf-8", "replace").strip()
+            if text.startswith("#BENCH "):
+                out.append(text)
+                print(text, file=sys.stderr)
+                if text.startswith("#BENCH end "):
+                    return out
+    sys.exit("no '#BENCH end' from the device within %d s" % timeout)
+
+
+def capture_http(url, token, fetch_url):
+    if fetch_url:
+        url += ("&" if "?" in url else "?") + "url=" + urllib.parse.quote(fetch_url, safe="")
+    req = urllib.request.Request(url)
+    if token:
+        req.add_header("Authorization", "Bearer " + token)
+    with urllib.request.urlopen(req, timeout=120) as r:
+        return [l for l in r.read().decode("utf-8", "replace").splitlines() if l.startswith("#BENCH ")]
+
+
+def compare(a, b, threshold):
+    for key in ("fw", "sdk", "compress", "flash"):
+        va, vb = a.get(("begin",), {}).get(key), b.get(("begin",), {}).get(key)
+        print("%-8s %s%s" % (key, va, "" if va == vb else "  ->  %s" % vb))
+    print()
+    print("%-24s %-10s %12s %12s %9s" % ("measurement", "metric", "A", "B", "change"))
+    worse = 0
+    for ident, fa in a.items():
+        fb = b.get(ident)
+        if not fb or ident[0] == "begin":
+            continue
+        for key, va in fa.items():
+            if key in ID_KEYS or key in INFO_KEYS or key not in fb:
+                continue
+            try:
+                x, y = float(va), float(fb[key])
+            except ValueError:
+                continue
+            change = (y - x) / x * 100 if x else 0.0
+            bad = -change if key in HIGHER_BETTER else change
+            flag = " !" if bad > threshold else ""
+            worse += bool(flag)
+            print("%-24s %-10s %12s %12s %+8.1f%%%s" % (" ".join(ident), key, va, fb[key], change, flag))
+    missing = [" ".join(i) for i in b if i not in a]
+    if missing:
+        print("\nonly in B: " + ", ".join(missing))
+    return worse
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("runs", nargs="*", help="two saved runs to compare")
+    ap.add_argument("--serial", help="run the suite over this serial port")
+    ap.add_argument("--url", help="run the suite over HTTP, e.g. http://<ip>/bench")
+    ap.add_argument("--token", help="push token for --url")
+    ap.add_argument("--fetch-url", help="URL for the fetch stage (default: the display's configured file)")
+    ap.add_argument("-o", "--output", help="where to save the run")
+    ap.add_argument("--threshold", type=float, default=5, help="percent worse to flag (default 5)")
+    args = ap.parse_args()
+
+    if args.serial or args.url:
+        lines = capture_serial(args.serial, args.fetch_url) if args.serial else \
+            capture_http(args.url, args.token, args.fetch_url)
+        if args.output:
+            with open(args.output, "w") as f:
+                f.write("\n".join(lines) + "\n")
+        else:
+            print("\n".join(lines))
+        return
+    if len(args.runs) != 2:
+        ap.error("give two saved runs to compare, or --serial / --url to make one")
+    with open(args.runs[0]) as fa, open(args.runs[1]) as fb:
+        worse = compare(parse(fa), parse(fb), args.threshold)
+    sys.exit(1 if worse else 0)
+
+
+if __name__ == "__main__":
+    main()
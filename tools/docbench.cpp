@@ -0,0 +1,98 @@
+// Host benchmark for the document store: plain vs LZ-compressed chunks.
+//
+//   g++ -O2 -std=gnu++17 -Itools/host -Iinclude tools/docbench.cpp -o docbench
+//   ./docbench file.txt [more files...]
+//
+// For each file it reports the compression ratio, how big a document fits in
+// a given amount of free heap, ingest time, a full sequential walk (what the
+// page index pass does) and the cost of reading one page at a random offset
+// (what renderPage() does). Host times are far shorter than on the ESP32;
+// compare the two columns, not the absolute numbers.
+#include <Arduino.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include "DocStore.h"
+
+#define HEAP_BUDGET (150 * 1024)  // free heap after WiFi + TLS on a CYD, roughly
+#define PAGE_CHARS  1040          // a full page at text size 1 (20 rows x 52 cols)
+#define NET_PIECE   1436          // bytes per TCP segment handed to the sink
+
+static double nowUs() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+struct Result {
+  int      heap;   // text only
+  int      fixed;  // per-document overhead (decode slots)
+  double   ingestUs, walkUs, pageUs;
+  uint32_t pageDecodes;
+};
+
+static Result run(const std::string &text, bool compress) {
+  Result r;
+  DocStore doc;
+  doc.setCompressed(compress);
+
+  double t0 = nowUs();
+  for (size_t p = 0; p < text.size(); p += NET_PIECE) {
+    doc.append((const uint8_t *)text.data() + p, std::min((size_t)NET_PIECE, text.size() - p));
+  }
+  doc.seal();
+  r.ingestUs = nowUs() - t0;
+  r.heap     = doc.heapBytes();
+  r.fixed    = compress ? 2 * DOC_CHUNK : 0;
+
+  volatile uint32_t sum = 0;
+  t0 = nowUs();
+  for (int i = 0; i < doc.length(); i++) sum += (uint8_t)doc[i];
+  r.walkUs = nowUs() - t0;
+
+  std::mt19937 rng(1);
+  const int pages = 2000;
+  int maxStart = std::max(0, doc.length() - PAGE_CHARS);
+  uint32_t d0 = doc.decodes();
+  t0 = nowUs();
+  for (int k = 0; k < pages; k++) {
+    int start = maxStart ? rng() % maxStart : 0;
+    int end   = std::min(doc.length(), start + PAGE_CHARS);
+    for (int i = start; i < end; i++) sum += (uint8_t)doc[i];
+  }
+  r.pageUs      = (nowUs() - t0) / pages;
+  r.pageDecodes = doc.decodes() - d0;
+  (void)sum;
+  return r;
+}
+
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    fprintf(stderr, "usage: %s file...\n", argv[0]);
+    return 1;
+  }
+  printf("%-28s %9s %7s %10s %10s %10s %10s %9s\n",
+         "file", "bytes", "ratio", "fits(KB)", "ingest us", "walk us", "page us", "dec/page");
+  for (int f = 1; f < argc; f++) {
+    std::ifstream in(argv[f], std::ios::binary);
+    if (!in) {
+      fprintf(stderr, "can't read %s\n", argv[f]);
+      continue;
+    }
+    std::stringstream ss;
+    ss << in.rdbuf();
+    std::string text = ss.str();
+    if (text.empty()) continue;
+
+    const char *name = strrchr(argv[f], '/') ? strrchr(argv[f], '/') + 1 : argv[f];
+    for (int z = 0; z <= 1; z++) {
+      Result r     = run(text, z);
+      double ratio = (double)text.size() / r.heap;
+      printf("%-22.22s %-5s %9zu %6.2fx %10.0f %10.0f %10.0f %10.2f %9.2f\n",
+             name, z ? "lz" : "plain", text.size(), ratio, (HEAP_BUDGET - r.fixed) * ratio / 1024,
+             r.ingestUs, r.walkUs, r.pageUs, r.pageDecodes / 2000.0);
+    }
+  }
+  return 0;
+}
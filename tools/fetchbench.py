@@ -0,0 +1,177 @@
+#!/usr/bin/env python3
+"""Benchmark the display's fetch pipeline against tools/rawserver.py.
+
+    python3 tools/fetchbench.py --serial /dev/ttyUSB0 --file big.txt
+    python3 tools/fetchbench.py --file big.txt            # host client only
+
+Starts rawserver (HTTPS, from its test CA) on this machine, then for every
+scenario below types `fetch https://<this machine>:8443/...` at the display's
+serial console. The display runs its normal HTTPS -> IngestSink -> layout ->
+draw path and reports back one #FETCH line, which is tabulated: connect and
+TLS time, time to first byte, total, throughput, and time to first page
+(request to the page on screen). Each scenario has an expected outcome;
+stalls past the 15 s read timeout and truncated bodies must fail, not show
+half a document.
+
+Without --serial the same scenarios run through a host HTTP client with the
+display's settings (15 s timeout, redirects followed, length checked), to
+check the server and get reference numbers. Close the serial monitor first;
+the display must already be on WiFi and run a build that trusts rawserver's
+CA (env:esp32dev-testca). Needs pyserial for --serial.
+"""
+import argparse
+import http.client
+import os
+import socket
+import ssl
+import sys
+import threading
+import time
+from urllib.parse import urlsplit
+
+sys.path.insert(0, os.path.dirname(os.path.abspath(__file__)))
+import rawserver  # noqa: E402
+
+DOC_PATH = "bench/fetch/main/doc.txt"
+
+# name, fault spec, should it succeed
+SCENARIOS = [
+    ("baseline",      "",                 True),
+    ("chunked",       "chunked",          True),
+    ("redirect x2",   "redirect=2",       True),
+    ("slow 20 KB/s",  "drip=20000",       True),
+    ("slow start 5s", "delay=5",          True),
+    ("stall 5s",      "stall={half}:5",   True),
+    ("stall 20s",     "stall={half}:20",  False),  # past the 15 s read timeout
+    ("truncated",     "truncate={half}",  False),
+    ("503",           "status=503",       False),
+]
+
+
+def local_ip():
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        s.connect(("10.255.255.255", 1))  # no packet is sent
+        return s.getsockname()[0]
+    finally:
+        s.close()
+
+
+def host_fetch(url):
+    """The display's fetch, done with http.client: returns the #FETCH fields."""
+    t0 = time.monotonic()
+    ctx = ssl.create_default_context(cafile=rawserver.CA)  # checked, as on the display
+    r = {"ok": 0, "code": 0, "bytes": 0, "size": -1}
+    for _ in range(5):
+        u = urlsplit(url)
+        conn = http.client.HTTPSConnection(u.hostname, u.port or 443, timeout=15, context=ctx)
+        try:
+            conn.connect()
+            r["connect_ms"] = (time.monotonic() - t0) * 1000
+            conn.request("GET", u.path, headers={"User-Agent": "fetchbench"})
+            resp = conn.getresponse()
+            r["code"] = resp.status
+            if resp.status in (301, 302, 307, 308):
+                url = "https://%s:%d%s" % (u.hostname, u.port or 443, resp.getheader("Location"))
+                resp.read()
+                continue
+            if resp.status != 200:
+                break
+            r["size"] = int(resp.getheader("Content-Length", -1))
+            n = 0
+            while True:
+                data = resp.read1(4096)
+                if not data:
+                    break
+                if not n:
+                    r["ttfb_ms"] = (time.monotonic() - t0) * 1000
+                n += len(data)
+            r["bytes"] = n
+            r["ok"] = int(r["size"] < 0 or n == r["size"])
+        except (socket.timeout, TimeoutError):
+            r["code"] = -11  # HTTPClient's read timeout
+        except (http.client.IncompleteRead, ConnectionError):
+            r["code"] = -5   # connection lost
+        finally:
+            conn.close()
+        break
+    r["total_ms"] = (time.monotonic() - t0) * 1000
+    r["first_page_ms"] = r["total_ms"] if r["ok"] else 0
+    return r
+
+
+class Device:
+    def __init__(self, port):
+        import serial
+        self.ser = serial.Serial(port, 115200, timeout=0.1)
+        self.buf = b""
+
+    def fetch(self, url, timeout=90):
+        self.ser.reset_input_buffer()
+        self.ser.write(b"\n")  # wakes a device in light sleep
+        time.sleep(0.1)
+        self.ser.write(b"fetch %s\n" % url.encode())
+        end = time.monotonic() + timeout
+        while time.monotonic() < end:
+            self.buf += self.ser.read(max(1, self.ser.in_waiting))
+            while b"\n" in self.buf:
+                line, self.buf = self.buf.split(b"\n", 1)
+                text = line.decode("utf-8", "replace").strip()
+                if text.startswith("#FETCH "):
+                    fields = dict(kv.split("=", 1) for kv in text.split()[1:] if "=" in kv)
+                    return {k: int(v) if v.lstrip("-").isdigit() else v for k, v in fields.items()}
+        return {"ok": 0, "code": "no reply"}
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("--serial", help="the display's serial port; without it a host client is used")
+    ap.add_argument("--file", help="document to serve (default: 200 KB of generated log lines)")
+    ap.add_argument("--host", help="address the display reaches this machine at (default: autodetect)")
+    ap.add_argument("--port", type=int, default=8443)
+    ap.add_argument("--only", help="run only scenarios whose name contains this")
+    args = ap.parse_args()
+
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), ".fetchbench")
+    os.makedirs(os.path.join(root, os.path.dirname(DOC_PATH)), exist_ok=True)
+    if args.file:
+        with open(args.file, "rb") as f:
+            doc = f.read()
+    else:
+        doc = b"".join(b"2024-05-01 12:%02d:%02d web-%02d GET /api/v1/items/%d 200 %d ms\n"
+                       % (i // 60 % 60, i % 60, i % 7, i, i % 300) for i in range(4000))
+    with open(os.path.join(root, DOC_PATH), "wb") as f:
+        f.write(doc)
+
+    host = args.host or ("localhost" if not args.serial else local_ip())
+    httpd = rawserver.serve(root, args.port, True, quiet=True, names=[host])
+    threading.Thread(target=httpd.serve_forever, daemon=True).start()
+    device = Device(args.serial) if args.serial else None
+    print("%d byte document, %s, server https://%s:%d\n" % (
+        len(doc), "display on " + args.serial if device else "host client", host, args.port))
+
+    cols = "%-14s %-6s %-7s %6s %8s %8s %7s %8s %7s %10s"
+    print(cols % ("scenario", "expect", "result", "code", "bytes", "connect", "ttfb", "total", "KB/s", "first page"))
+    failures = 0
+    for name, spec, expect_ok in SCENARIOS:
+        if args.only and args.only not in name:
+            continue
+        spec = spec.format(half=len(doc) // 2)
+        url = "https://%s:%d/%s%s" % (host, args.port, "_" + spec + "/" if spec else "", DOC_PATH)
+        r = device.fetch(url) if device else host_fetch(url)
+        ok = bool(r.get("ok"))
+        good = ok == expect_ok
+        failures += not good
+        total = r.get("total_ms", 0)
+        print(cols % (name, "ok" if expect_ok else "fail", ("ok" if ok else "failed") + ("" if good else " !"),
+                      r.get("code", ""), r.get("bytes", ""), "%.0f" % r.get("connect_ms", 0),
+                      "%.0f" % r.get("ttfb_ms", 0), "%.0f" % total,
+                      "%.0f" % (r.get("bytes", 0) / total if total and ok else 0),
+                      "%.0f" % r.get("first_page_ms", 0) if ok else "-"))
+    httpd.shutdown()
+    print("\nall scenarios as expected" if not failures else "\n%d scenario(s) not as expected (!)" % failures)
+    sys.exit(1 if failures else 0)
+
+
+if __name__ == "__main__":
+    main()
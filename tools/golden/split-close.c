@@ -0,0 +1,6 @@
+// Block comment closes cut by a row boundary at text sizes 1, 2 and 3
+int before = 1;
+/*xxxxxxxxxxxxxx*/ int after17 = 17;
+/*xxxxxxxxxxxxxxxxxxxxxxx*/ int after26 = 26;
+/*xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx*/ int after52 = 52;
+char *s = "still code";
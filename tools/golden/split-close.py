@@ -0,0 +1,9 @@
+# Triple-quote closes cut after one and two quotes at sizes 1, 2 and 3
+before = 1
+"""xxxxxxxxxxxxx""" + after17
+"""xxxxxxxxxxxx""" + after17
+"""xxxxxxxxxxxxxxxxxxxxxx""" + after26
+"""xxxxxxxxxxxxxxxxxxxxx""" + after26
+"""xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx""" + after52
+"""xxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxxx""" + after52
+s = 'still code'
@@ -0,0 +1,30 @@
+#pragma once
+
+// Just enough of the Arduino core for host builds of the firmware's
+// platform-independent headers (DocStore.h, LZBlock.h, Layout.h, PagePack.h,
+// and with Arduino_GFX_Library.h here, Theme.h and Render.h) in tools/.
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <string>
+
+using std::max;
+using std::min;
+
+template <class T, class L, class H> static T constrain(T x, L lo, H hi) {
+  return x < lo ? lo : x > hi ? hi : x;
+}
+
+class String {
+public:
+  String() {}
+  String(const char *s) : _s(s) {}
+  void        reserve(unsigned int n)                 { _s.reserve(n); }
+  bool        concat(const char *s, unsigned int n)   { _s.append(s, n); return true; }
+  unsigned    length() const                          { return _s.size(); }
+  const char *c_str() const                           { return _s.c_str(); }
+
+private:
+  std::string _s;
+};
@@ -0,0 +1,202 @@
+#pragma once
+
+// Just enough of Arduino_GFX 1.4 for host builds of the render code
+// (Render.h, Glyphs.h, BusStats.h) in tools/. The classes have the same
+// names and virtuals as the library's, and drawing goes out as the same bus
+// traffic the library sends an ILI9341: address window (CASET, PASET,
+// RAMWR) and pixels, one window per lit pixel for text at size 1 and per
+// font pixel at sizes 2 and 3. A HostPanel bus (HostPanel.h) turns that
+// traffic into a framebuffer.
+//
+// Text uses the firmware's font (Font.h), printable ASCII only: other bytes
+// come out as blank cells, where the real library draws its CP437 glyphs.
+#include <Arduino.h>
+#include "Font.h"
+
+#define GFX_NOT_DEFINED -1
+#define RGB565_BLACK    0x0000
+#define RGB565_WHITE    0xFFFF
+
+#define ILI9341_INVOFF 0x20
+#define ILI9341_INVON  0x21
+#define ILI9341_CASET  0x2A
+#define ILI9341_PASET  0x2B
+#define ILI9341_RAMWR  0x2C
+
+class Arduino_DataBus {
+public:
+  virtual ~Arduino_DataBus() {}
+
+  virtual bool begin(int32_t speed = GFX_NOT_DEFINED, int8_t dataMode = GFX_NOT_DEFINED) = 0;
+  virtual void beginWrite() = 0;
+  virtual void endWrite() = 0;
+  virtual void writeCommand(uint8_t c) = 0;
+  virtual void writeCommand16(uint16_t c) = 0;
+  virtual void write(uint8_t d) = 0;
+  virtual void write16(uint16_t d) = 0;
+
+  virtual void writeC8D8(uint8_t c, uint8_t d)                    { writeCommand(c); write(d); }
+  virtual void writeC8D16(uint8_t c, uint16_t d)                  { writeCommand(c); write16(d); }
+  virtual void writeC8D16D16(uint8_t c, uint16_t d1, uint16_t d2) { writeCommand(c); write16(d1); write16(d2); }
+
+  virtual void writeRepeat(uint16_t p, uint32_t len) = 0;
+  virtual void writePixels(uint16_t *data, uint32_t len) = 0;
+  virtual void writeBytes(uint8_t *data, uint32_t len) = 0;
+  virtual void writePattern(uint8_t *data, uint8_t len, uint32_t repeat) {
+    while (repeat--) writeBytes(data, len);
+  }
+  virtual void writeIndexedPixels(uint8_t *data, uint16_t *idx, uint32_t len) {
+    while (len--) write16(idx[*data++]);
+  }
+  virtual void writeIndexedPixelsDouble(uint8_t *data, uint16_t *idx, uint32_t len) {
+    while (len--) {
+      write16(idx[*data]);
+      write16(idx[*data++]);
+    }
+  }
+};
+
+class Arduino_GFX {
+public:
+  Arduino_GFX(int16_t w, int16_t h) : _w(w), _h(h) {}
+  virtual ~Arduino_GFX() {}
+
+  int16_t width() const  { return _w; }
+  int16_t height() const { return _h; }
+
+  virtual void startWrite() = 0;
+  virtual void endWrite() = 0;
+  virtual void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) = 0;
+  virtual void invertDisplay(bool i) = 0;
+
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    if (w < 0) { x += w; w = -w; }
+    if (h < 0) { y += h; h = -h; }
+    int16_t x1 = min((int)_w, x + w), y1 = min((int)_h, y + h);
+    x = max((int16_t)0, x);
+    y = max((int16_t)0, y);
+    if (x >= x1 || y >= y1) return;
+    startWrite();
+    writeFillRectPreclipped(x, y, x1 - x, y1 - y, color);
+    endWrite();
+  }
+  void fillScreen(uint16_t color) { fillRect(0, 0, _w, _h, color); }
+
+  void setTextSize(uint8_t s)                  { _size = max((uint8_t)1, s); }
+  void setTextColor(uint16_t c)                { _fg = _bg = c; }  // same colors = transparent
+  void setTextColor(uint16_t c, uint16_t bg)   { _fg = c; _bg = bg; }
+  void setCursor(int16_t x, int16_t y)         { _cx = x; _cy = y; }
+  int16_t getCursorX() const                   { return _cx; }
+  int16_t getCursorY() const                   { return _cy; }
+
+  // The classic 5x7 font cell: lit pixels in fg, the rest in bg unless the
+  // two are equal (transparent)
+  void drawChar(int16_t x, int16_t y, unsigned char c, uint16_t fg, uint16_t bg) {
+    if (x + 6 * _size <= 0 || y + 8 * _size <= 0 || x >= _w || y >= _h) return;
+    bool glyph = c >= GLYPH_FIRST && c <= GLYPH_LAST;
+    startWrite();
+    for (int i = 0; i < 5; i++) {
+      uint8_t line = glyph ? GLYPH_FONT[c - GLYPH_FIRST][i] : 0;
+      for (int j = 0; j < 8; j++, line >>= 1) {
+        if (line & 1)     pixel(x + i * _size, y + j * _size, fg);
+        else if (bg != fg) pixel(x + i * _size, y + j * _size, bg);
+      }
+    }
+    if (bg != fg) clipFill(x + 5 * _size, y, _size, 8 * _size, bg);
+    endWrite();
+  }
+
+  size_t write(uint8_t c) {
+    if (c == '\n') {
+      _cx = 0;
+      _cy += 8 * _size;
+    } else if (c != '\r') {
+      if (_cx + 6 * _size > _w) {  // text wrap, as the library does by default
+        _cx = 0;
+        _cy += 8 * _size;
+      }
+      drawChar(_cx, _cy, c, _fg, _bg);
+      _cx += 6 * _size;
+    }
+    return 1;
+  }
+  size_t print(const char *s) {
+    size_t n = 0;
+    while (*s) n += write((uint8_t)*s++);
+    return n;
+  }
+  size_t print(const String &s) {
+    for (unsigned i = 0; i < s.length(); i++) write((uint8_t)s.c_str()[i]);
+    return s.length();
+  }
+
+protected:
+  int16_t  _w, _h;
+  int16_t  _cx = 0, _cy = 0;
+  uint8_t  _size = 1;
+  uint16_t _fg = RGB565_WHITE, _bg = RGB565_WHITE;
+
+private:
+  // One font pixel: a 1x1 window at size 1, a size x size one above
+  void pixel(int16_t x, int16_t y, uint16_t color) { clipFill(x, y, _size, _size, color); }
+
+  void clipFill(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) {
+    int16_t x1 = min((int)_w, x + w), y1 = min((int)_h, y + h);
+    x = max((int16_t)0, x);
+    y = max((int16_t)0, y);
+    if (x < x1 && y < y1) writeFillRectPreclipped(x, y, x1 - x, y1 - y, color);
+  }
+};
+
+class Arduino_TFT : public Arduino_GFX {
+public:
+  Arduino_TFT(Arduino_DataBus *bus, int16_t w, int16_t h) : Arduino_GFX(w, h), _bus(bus) {}
+
+  void startWrite() override { _bus->beginWrite(); }
+  void endWrite() override   { _bus->endWrite(); }
+  virtual void writeAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) = 0;
+
+  void writeFillRectPreclipped(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t color) override {
+    writeAddrWindow(x, y, w, h);
+    _bus->writeRepeat(color, (uint32_t)w * h);
+  }
+
+protected:
+  Arduino_DataBus *_bus;
+};
+
+// ILI9341 in landscape (rotation 1): 320 x 240. Like the library, it only
+// resends the column or row range when it changed.
+class Arduino_ILI9341 : public Arduino_TFT {
+public:
+  Arduino_ILI9341(Arduino_DataBus *bus, int8_t rst = GFX_NOT_DEFINED, uint8_t rotation = 1)
+      : Arduino_TFT(bus, rotation & 1 ? 320 : 240, rotation & 1 ? 240 : 320) {
+    (void)rst;
+  }
+
+  bool begin(int32_t speed = GFX_NOT_DEFINED) { return _bus->begin(speed); }
+
+  void writeAddrWindow(int16_t x, int16_t y, uint16_t w, uint16_t h) override {
+    if (x != _curX || w != _curW) {
+      _bus->writeC8D16D16(ILI9341_CASET, x, x + w - 1);
+      _curX = x;
+      _curW = w;
+    }
+    if (y != _curY || h != _curH) {
+      _bus->writeC8D16D16(ILI9341_PASET, y, y + h - 1);
+      _curY = y;
+      _curH = h;
+    }
+    _bus->writeCommand(ILI9341_RAMWR);
+  }
+
+  void invertDisplay(bool i) override {
+    _bus->beginWrite();
+    _bus->writeCommand(i ? ILI9341_INVON : ILI9341_INVOFF);
+    _bus->endWrite();
+  }
+
+private:
+  int16_t  _curX = -1, _curY = -1;
+  uint16_t _curW = 0, _curH = 0;
+};
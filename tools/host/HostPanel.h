@@ -0,0 +1,173 @@
+#pragma once
+
+// A 320 x 240 ILI9341 on the host: a data bus that decodes the commands and
+// pixels Arduino_GFX sends into a framebuffer, for tools that render with
+// the firmware's drawing code (tools/rendertest.cpp). Only what the render
+// code uses is decoded: column and row address (CASET, PASET), memory write
+// (RAMWR) and inversion (INVON, INVOFF). The panel can be saved as a PNG the
+// way it looks, i.e. inverted when inversion is on.
+#include <cstdio>
+#include <vector>
+#include <Arduino_GFX_Library.h>
+
+class HostPanel : public Arduino_DataBus {
+public:
+  static const int W = 320, H = 240;
+
+  uint16_t fb[W * H] = {};   // RGB565 as stored in panel RAM
+  bool     inverted  = false;
+
+  bool begin(int32_t, int8_t) override { return true; }
+  void beginWrite() override {}
+  void endWrite() override {}
+
+  void writeCommand(uint8_t c) override {
+    _cmd = c;
+    _nparam = 0;
+    _half = -1;
+    if (c == ILI9341_INVON || c == ILI9341_INVOFF) inverted = c == ILI9341_INVON;
+    if (c == ILI9341_RAMWR) {
+      _x = _x0;
+      _y = _y0;
+    }
+  }
+  void writeCommand16(uint16_t c) override { writeCommand((uint8_t)c); }
+
+  void write(uint8_t d) override {
+    if (_cmd != ILI9341_RAMWR) {
+      param(d);
+    } else if (_half < 0) {
+      _half = d;
+    } else {
+      pixel(_half << 8 | d);
+      _half = -1;
+    }
+  }
+  void write16(uint16_t d) override {
+    if (_cmd == ILI9341_RAMWR) {
+      pixel(d);
+    } else {
+      param(d >> 8);
+      param(d & 0xFF);
+    }
+  }
+
+  void writeRepeat(uint16_t p, uint32_t len) override     { while (len--) pixel(p); }
+  void writePixels(uint16_t *data, uint32_t len) override { while (len--) pixel(*data++); }
+  void writeBytes(uint8_t *data, uint32_t len) override   { while (len--) write(*data++); }
+
+  // A pixel as seen on the glass
+  uint16_t shown(int x, int y) const { return inverted ? (uint16_t)~fb[y * W + x] : fb[y * W + x]; }
+
+  // CRC-32 of the visible image, RGB565 little-endian, row by row
+  uint32_t crc() const {
+    uint32_t c = 0;
+    for (int y = 0; y < H; y++) {
+      for (int x = 0; x < W; x++) {
+        uint16_t p = shown(x, y);
+        uint8_t  b[2] = { (uint8_t)p, (uint8_t)(p >> 8) };
+        c = crc32(c, b, 2);
+      }
+    }
+    return c;
+  }
+
+  // The visible image as an RGB PNG (uncompressed deflate, no zlib needed)
+  bool savePng(const char *path) const {
+    std::vector<uint8_t> raw;
+    raw.reserve(H * (1 + W * 3));
+    for (int y = 0; y < H; y++) {
+      raw.push_back(0);  // filter: none
+      for (int x = 0; x < W; x++) {
+        uint16_t p = shown(x, y);
+        raw.push_back((p >> 11) << 3 | (p >> 13));
+        raw.push_back((p >> 5 & 0x3F) << 2 | (p >> 9 & 0x03));
+        raw.push_back((p & 0x1F) << 3 | (p >> 2 & 0x07));
+      }
+    }
+
+    std::vector<uint8_t> z = { 0x78, 0x01 };
+    for (size_t at = 0; at < raw.size();) {
+      size_t n = min((size_t)0xFFFF, raw.size() - at);
+      z.push_back(at + n == raw.size());  // final block flag, type 0 (stored)
+      put16le(z, n);
+      put16le(z, ~n & 0xFFFF);
+      z.insert(z.end(), raw.begin() + at, raw.begin() + at + n);
+      at += n;
+    }
+    put32be(z, adler32(raw));
+
+    std::vector<uint8_t> ihdr;
+    put32be(ihdr, W);
+    put32be(ihdr, H);
+    ihdr.insert(ihdr.end(), { 8, 2, 0, 0, 0 });  // 8 bit RGB
+
+    std::vector<uint8_t> png = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+    chunk(png, "IHDR", ihdr);
+    chunk(png, "IDAT", z);
+    chunk(png, "IEND", {});
+
+    FILE *f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(png.data(), 1, png.size(), f) == png.size();
+    return fclose(f) == 0 && ok;
+  }
+
+private:
+  uint8_t  _cmd = 0;
+  uint8_t  _params[4];
+  int      _nparam = 0;
+  int      _half = -1;              // first byte of a pixel sent with write()
+  int      _x0 = 0, _x1 = W - 1, _y0 = 0, _y1 = H - 1;
+  int      _x = 0, _y = 0;          // next pixel of the RAMWR
+
+  void param(uint8_t d) {
+    if (_nparam < 4) _params[_nparam++] = d;
+    if (_nparam != 4) return;
+    int a = _params[0] << 8 | _params[1], b = _params[2] << 8 | _params[3];
+    if (_cmd == ILI9341_CASET) { _x0 = a; _x1 = b; }
+    if (_cmd == ILI9341_PASET) { _y0 = a; _y1 = b; }
+  }
+
+  // The controller fills the window left to right, top to bottom, and
+  // drops whatever is sent past its end
+  void pixel(uint16_t p) {
+    if (_y > _y1) return;
+    if (_x < W && _y < H) fb[_y * W + _x] = p;
+    if (++_x > _x1) {
+      _x = _x0;
+      _y++;
+    }
+  }
+
+  static uint32_t crc32(uint32_t crc, const uint8_t *p, size_t n) {
+    crc = ~crc;
+    while (n--) {
+      crc ^= *p++;
+      for (int k = 0; k < 8; k++) crc = (crc >> 1) ^ (0xEDB88320 & (0 - (crc & 1)));
+    }
+    return ~crc;
+  }
+
+  static uint32_t adler32(const std::vector<uint8_t> &d) {
+    uint32_t a = 1, b = 0;
+    for (uint8_t c : d) {
+      a = (a + c) % 65521;
+      b = (b + a) % 65521;
+    }
+    return b << 16 | a;
+  }
+
+  static void put16le(std::vector<uint8_t> &v, uint32_t x) { v.insert(v.end(), { (uint8_t)x, (uint8_t)(x >> 8) }); }
+  static void put32be(std::vector<uint8_t> &v, uint32_t x) {
+    v.insert(v.end(), { (uint8_t)(x >> 24), (uint8_t)(x >> 16), (uint8_t)(x >> 8), (uint8_t)x });
+  }
+
+  static void chunk(std::vector<uint8_t> &png, const char *type, const std::vector<uint8_t> &data) {
+    put32be(png, data.size());
+    size_t start = png.size();
+    png.insert(png.end(), type, type + 4);
+    png.insert(png.end(), data.begin(), data.end());
+    put32be(png, crc32(0, png.data() + start, png.size() - start));
+  }
+};
@@ -0,0 +1,269 @@
+// Fuzz harness for the page layout (wcWrapPage, Layout.h), run on the host.
+//
+//   g++ -O2 -std=gnu++17 -Itools/host -Iinclude tools/layoutfuzz.cpp -o layoutfuzz
+//   ./layoutfuzz                  # built-in edge cases + 20000 random documents
+//   ./layoutfuzz -n 1000000 -s 7  # more random documents, another seed
+//   ./layoutfuzz crash-1234       # replay saved inputs
+//
+//   clang++ -g -O1 -fsanitize=fuzzer,address,undefined -DLIBFUZZER -std=gnu++17
+//       -Itools/host -Iinclude tools/layoutfuzz.cpp -o layoutfuzz   (one line)
+//   ./layoutfuzz -max_len=20000 corpus/
+//
+// AFL++ takes the same libFuzzer build (afl-clang-fast++ instead of clang++).
+// A fuzz input is one byte for maxCols, one for the rows per page, then the
+// document. Each document is laid out page by page the way buildPageIndex()
+// does, over a DocStore (both plain and compressed) and checked for:
+//
+//  - forward progress: every page ends where the next one starts, later
+//    than it started, and the page sequence ends
+//  - coverage: every byte is in exactly one row, or is one the layout may
+//    drop (LF, CR before LF or at the end, spaces where a row wrapped)
+//  - rows: no longer than maxCols, no newline inside, a wrapped row starts
+//    with no space and was cut at maxCols or at a space
+//  - cost: reads of the body per page stay within a linear bound of the
+//    bytes the page covers plus O(maxCols) per row. Reads are counted
+//    rather than timed so the check is exact under sanitizers; a layout
+//    that rescans the rest of a long line on every page trips it at once.
+//
+// Any failure prints the case and aborts, which is what the fuzzers look for.
+#include <Arduino.h>
+#include <chrono>
+#include <cstdarg>
+#include <cstdio>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <vector>
+#include "DocStore.h"
+#include "Layout.h"
+
+#define FUZZ_MAX_COLS 60
+#define FUZZ_MAX_ROWS 24
+#define NET_PIECE     1436  // bytes per append, as from the network
+
+// A DocStore that counts the bytes the layout reads
+struct CountingBody {
+  const DocStore   &doc;
+  mutable uint64_t  reads = 0;
+
+  int  length() const { return doc.length(); }
+  char operator[](int i) const { reads++; return doc[i]; }
+  int  indexOf(char c, int from, int to) const {
+    int hit = doc.indexOf(c, from, to);
+    reads += (hit == -1 ? min(to, doc.length()) : hit + 1) - from;
+    return hit;
+  }
+};
+
+struct Case {
+  const char *text;
+  int         len, maxCols, rows;
+  bool        compressed;
+};
+
+static void fail(const Case &c, const char *fmt, ...) {
+  fprintf(stderr, "layoutfuzz: maxCols %d, rows %d, %d bytes%s: ", c.maxCols, c.rows, c.len,
+          c.compressed ? " (compressed)" : "");
+  va_list ap;
+  va_start(ap, fmt);
+  vfprintf(stderr, fmt, ap);
+  va_end(ap);
+  fputc('\n', stderr);
+  if (c.len <= 200) {
+    fputs("  text: \"", stderr);
+    for (int i = 0; i < c.len; i++) {
+      unsigned char ch = c.text[i];
+      if (ch == '\n')                fputs("\\n", stderr);
+      else if (ch == '\r')           fputs("\\r", stderr);
+      else if (ch < 32 || ch > 126)  fprintf(stderr, "\\x%02x", ch);
+      else                           fputc(ch, stderr);
+    }
+    fputs("\"\n", stderr);
+  }
+  abort();
+}
+
+static bool lineStartAt(const Case &c, int i) { return i == 0 || c.text[i - 1] == '\n'; }
+
+// Bytes [from, to) that no row covers: a wrap's spaces, then line ends
+static void checkGap(const Case &c, int from, int to, bool afterRow) {
+  int i = from;
+  if (afterRow && !lineStartAt(c, from)) {
+    while (i < to && c.text[i] == ' ') i++;
+  }
+  for (; i < to; i++) {
+    char ch = c.text[i];
+    if (ch == '\n') continue;
+    if (ch == '\r' && (i + 1 == c.len || c.text[i + 1] == '\n')) continue;
+    fail(c, "byte %d (0x%02x) is in no row", i, (unsigned char)ch);
+  }
+}
+
+static void checkLayout(const Case &c) {
+  DocStore doc;
+  doc.setCompressed(c.compressed);
+  for (int p = 0; p < c.len; p += NET_PIECE) {
+    doc.append((const uint8_t *)c.text + p, min(NET_PIECE, c.len - p));
+  }
+  doc.seal();
+  CountingBody body{doc};
+
+  int covered = 0;  // bytes before this are accounted for
+  int lastRow = -1;
+  int start   = 0;
+  int pages   = 0;
+  while (start != -1) {
+    if (++pages > c.len + 1) fail(c, "more pages than bytes");
+    uint64_t reads0 = body.reads;
+    int rowsHere = 0;
+    int next = wcWrapPage(body, start, c.maxCols, c.rows, [&](int from, int to, int i) {
+      if (i != rowsHere++)          fail(c, "row %d numbered %d", rowsHere - 1, i);
+      if (from < covered)           fail(c, "row [%d, %d) overlaps the one before", from, to);
+      if (to <= from)               fail(c, "empty row at %d", from);
+      if (to - from > c.maxCols)    fail(c, "row [%d, %d) longer than maxCols", from, to);
+      if (memchr(c.text + from, '\n', to - from)) fail(c, "row [%d, %d) has a newline", from, to);
+      if (!lineStartAt(c, from) && c.text[from] == ' ')
+        fail(c, "wrapped row at %d starts with a space", from);
+      bool lineEnds = to == c.len || c.text[to] == '\n' ||
+                      (c.text[to] == '\r' && (to + 1 == c.len || c.text[to + 1] == '\n'));
+      if (!lineEnds && to - from < c.maxCols && c.text[to] != ' ')
+        fail(c, "row [%d, %d) cut short, not at a space", from, to);
+      checkGap(c, covered, from, covered == lastRow);
+      covered = lastRow = to;
+    });
+    if (rowsHere > c.rows) fail(c, "page at %d has %d rows", start, rowsHere);
+
+    int until = next == -1 ? c.len + 1 : next;  // +1: the end of the last line
+    if (next != -1 && next <= start) fail(c, "page at %d is followed by %d", start, next);
+    if (next != -1 && rowsHere < c.rows) fail(c, "page at %d ended with %d free rows", start, c.rows - rowsHere);
+    uint64_t reads = body.reads - reads0;
+    uint64_t bound = 2 * (uint64_t)(until - start) + (uint64_t)(c.rows + 1) * (2 * c.maxCols + 4) + 8;
+    if (reads > bound)
+      fail(c, "page at %d read %llu bytes to cover %d (bound %llu)", start,
+           (unsigned long long)reads, until - start, (unsigned long long)bound);
+    start = next;
+  }
+  checkGap(c, covered, c.len, covered == lastRow);
+}
+
+static void checkInput(const uint8_t *data, size_t size) {
+  if (size < 2) return;
+  int maxCols = 1 + data[0] % FUZZ_MAX_COLS;
+  int rows    = 1 + data[1] % FUZZ_MAX_ROWS;
+  for (int z = 0; z <= 1; z++) {
+    checkLayout({ (const char *)data + 2, (int)size - 2, maxCols, rows, (bool)z });
+  }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+  checkInput(data, size);
+  return 0;
+}
+
+#ifndef LIBFUZZER
+
+static double nowUs() {
+  using namespace std::chrono;
+  return duration<double, std::micro>(steady_clock::now().time_since_epoch()).count();
+}
+
+// Layout speed of a whole document, for the report
+static double nsPerByte(const std::string &text, int maxCols, int rows) {
+  DocStore doc;
+  doc.append((const uint8_t *)text.data(), text.size());
+  doc.seal();
+  double t0 = nowUs();
+  int pages = 0;
+  for (int start = 0; start != -1; pages++) {
+    start = wcWrapPage(doc, start, maxCols, rows, [](int, int, int) {});
+  }
+  return (nowUs() - t0) * 1000 / text.size();
+}
+
+static std::string repeat(const std::string &s, int n) {
+  std::string out;
+  for (int i = 0; i < n; i++) out += s;
+  return out;
+}
+
+int main(int argc, char **argv) {
+  long     count = 20000;
+  uint32_t seed  = 1;
+  std::vector<const char *> files;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-n") && i + 1 < argc)      count = atol(argv[++i]);
+    else if (!strcmp(argv[i], "-s") && i + 1 < argc) seed = atol(argv[++i]);
+    else                                             files.push_back(argv[i]);
+  }
+
+  if (!files.empty()) {
+    for (const char *f : files) {
+      std::ifstream in(f, std::ios::binary);
+      std::stringstream ss;
+      ss << in.rdbuf();
+      std::string data = ss.str();
+      checkInput((const uint8_t *)data.data(), data.size());
+      printf("%s: ok\n", f);
+    }
+    return 0;
+  }
+
+  // The shapes the wrap loop treats specially, at the CYD's page sizes
+  // (52 x 22 at text size 1, 17 x 11 at size 3) and at a tiny one
+  const int sizes[][2] = { {52, 22}, {26, 11}, {17, 11}, {1, 1}, {3, 2} };
+  const std::string edges[] = {
+    std::string(200000, 'x'),                       // one line, no spaces
+    std::string(20000, ' '),                        // spaces only
+    repeat("abc def\r", 3000),                      // CR-only line ends
+    repeat("\n", 5000) + "end",                     // newline runs
+    repeat("\r\n", 5000),
+    repeat(std::string(52, 'm') + "\n", 500),       // exactly maxCols at size 1
+    repeat(std::string(52, 'm') + "\r\n", 500),
+    repeat(std::string(53, 'm') + "\n", 500),
+    repeat(std::string(17, 'w') + " ", 5000),       // exactly maxCols at size 3, then a space
+    repeat("a ", 50000),                            // a space every other byte
+    repeat(" a", 50000),
+    repeat("word ", 40000) + "\r",
+  };
+  int cases = 0;
+  for (const std::string &text : edges) {
+    for (const auto &sz : sizes) {
+      for (int z = 0; z <= 1; z++) {
+        checkLayout({ text.data(), (int)text.size(), sz[0], sz[1], (bool)z });
+        cases++;
+      }
+    }
+  }
+
+  // Random documents over a small alphabet, so lines, spaces and CRs collide
+  std::mt19937 rng(seed);
+  const char alphabet[] = "aaaaaaab    \n\n\r";
+  std::vector<uint8_t> buf;
+  for (long k = 0; k < count; k++) {
+    int len = rng() % (k % 100 == 0 ? 20000 : 300);
+    buf.resize(len + 2);
+    buf[0] = rng();
+    buf[1] = rng();
+    int run = 1 + rng() % 80;  // long runs of one byte now and then
+    for (int i = 2; i < len + 2; i++) {
+      buf[i] = (i % run == 0 && rng() % 2) ? buf[i - 1] : alphabet[rng() % (sizeof(alphabet) - 1)];
+    }
+    checkInput(buf.data(), buf.size());
+    cases += 2;
+  }
+  printf("%d layouts checked, all invariants held\n\n", cases);
+
+  printf("%-24s %10s %10s\n", "layout speed (52 x 22)", "bytes", "ns/byte");
+  const struct { const char *name; std::string text; } speed[] = {
+    { "prose",               repeat("The quick brown fox jumps over the lazy dog. ", 20000) },
+    { "one long line",       std::string(1000000, 'x') },
+    { "spaces only",         std::string(1000000, ' ') },
+    { "short lines",         repeat("ok\n", 300000) },
+  };
+  for (const auto &s : speed) {
+    printf("%-24s %10zu %10.2f\n", s.name, s.text.size(), nsPerByte(s.text, 52, 22));
+  }
+  return 0;
+}
+
+#endif
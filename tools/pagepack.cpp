@@ -0,0 +1,199 @@
+// Page pack compiler: lays out a text file on the PC, with the firmware's own
+// wrapping code (Layout.h), into a pack the display draws without laying
+// anything out (format in include/PagePack.h).
+//
+//   g++ -O2 -std=gnu++17 -Itools/host -Iinclude tools/pagepack.cpp -o pagepack
+//   ./pagepack notes.txt notes.cydp                   # a single pane at size 1
+//   ./pagepack notes.txt notes.cydp --size 2 --rainbow --bitmaps
+//   ./pagepack --check notes.cydp [--dump]
+//
+// --pane W H is the pane in pixels (default 320 206: the whole text area
+// between status bar and footer). Colors are theme indices, so a pack follows the
+// display's theme: --color N (0-5, the `color` setting) or --rainbow.
+// --bitmaps adds every row pre-rendered at 1 bit per pixel; the display then
+// streams them straight to the panel instead of drawing glyphs.
+#include <Arduino.h>
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include "DocStore.h"
+#include "Font.h"
+#include "Layout.h"
+#include "PagePack.h"
+
+#define RAINBOW_COLORS 7  // MULTI_COLOR_COUNT in Theme.h
+
+struct Options {
+  int  size = 1, paneW = 320, paneH = 206, color = 0;
+  bool rainbow = false, bitmaps = false, dump = false;
+};
+
+static bool readFile(const char *path, std::string &out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  out = ss.str();
+  return true;
+}
+
+static void loadDoc(const std::string &data, DocStore &doc) {
+  doc.append((const uint8_t *)data.data(), data.size());
+  doc.seal();
+}
+
+static bool printable(uint8_t c) { return c >= GLYPH_FIRST && c <= GLYPH_LAST; }
+
+// The row's glyph cells at size S, 1 bit per pixel, h scanlines of stride bytes
+template <int S>
+static void renderRow(const char *s, int n, int stride, uint8_t *out) {
+  static constexpr ScaledGlyphs<S> font{};
+  for (int i = 0; i < n; i++) {
+    const uint8_t *g = font.bits[(uint8_t)s[i] - GLYPH_FIRST];
+    for (int y = 0; y < font.H; y++) {
+      for (int x = 0; x < font.W; x++) {
+        if (g[y * font.ROW + x / 8] & (0x80 >> (x % 8))) {
+          int px = i * font.W + x;
+          out[y * stride + px / 8] |= 0x80 >> (px % 8);
+        }
+      }
+    }
+  }
+}
+
+static void renderRow(int size, const char *s, int n, int stride, uint8_t *out) {
+  if (size == 1)      renderRow<1>(s, n, stride, out);
+  else if (size == 2) renderRow<2>(s, n, stride, out);
+  else                renderRow<3>(s, n, stride, out);
+}
+
+static void dump(const DocStore &pack, const PackInfo &h) {
+  printf("size %u (%ux%u px cell), %u cols x %u rows, %u pages, %u rows of text, text %u bytes%s\n", h.textSize,
+         h.charW, h.lineH, h.cols, h.rows, h.pages, h.rowCount, h.textLen,
+         h.bitsOff ? ", bitmaps" : "");
+  std::vector<char> text(h.cols + 1);
+  for (uint32_t pg = 0; pg < h.pages; pg++) {
+    printf("--- page %u\n", pg + 1);
+    for (uint32_t i = wcPackPageRow(pack, h, pg); i < wcPackPageRow(pack, h, pg + 1); i++) {
+      PackRow r = wcPackRow(pack, h, i);
+      pack.copy(h.textOff + r.off, h.textOff + r.off + r.len, text.data());
+      for (int k = 0; k < r.len; k++) text[k] = printable(text[k]) ? text[k] : '?';
+      text[r.len] = 0;
+      printf("%c%-3u %s\n", r.flags & PACK_ROW_TEXT ? '*' : ' ',
+             r.color & PACK_MULTI ? 100 + (r.color & ~PACK_MULTI) : r.color, text.data());
+    }
+  }
+}
+
+static int check(const char *path, bool showRows) {
+  std::string data;
+  if (!readFile(path, data)) { fprintf(stderr, "pagepack: can't read %s\n", path); return 1; }
+  DocStore pack;
+  loadDoc(data, pack);
+  PackInfo h;
+  PackStatus s = wcPackCheck(pack, h);
+  if (s != PACK_OK) {
+    fprintf(stderr, "pagepack: %s: %s\n", path, s == PACK_NONE ? "not a page pack" : wcPackError(s));
+    return 1;
+  }
+  if (showRows) dump(pack, h);
+  else printf("%s: ok, %u pages at size %u (%ux%u)\n", path, h.pages, h.textSize, h.cols, h.rows);
+  return 0;
+}
+
+static int build(const char *inPath, const char *outPath, const Options &o) {
+  std::string text;
+  if (!readFile(inPath, text)) { fprintf(stderr, "pagepack: can't read %s\n", inPath); return 1; }
+  if (text.compare(0, 4, PACK_MAGIC) == 0) { fprintf(stderr, "pagepack: %s is a pack already\n", inPath); return 1; }
+  DocStore doc;
+  loadDoc(text, doc);
+
+  PackInfo h;
+  h.version  = PACK_VERSION;
+  h.textSize = o.size;
+  h.charW    = wcCharW(o.size);
+  h.lineH    = wcLineH(o.size);
+  h.cols     = wcLayoutCols(o.paneW, o.size);
+  h.rows     = wcLayoutRows(o.paneH, o.size);
+  if (h.rows < 1) { fprintf(stderr, "pagepack: a %d px pane has no room for a row\n", o.paneH); return 1; }
+
+  // Page by page, exactly as buildPageIndex() would on the device
+  std::vector<PackRow>  rows;
+  std::vector<uint32_t> pageRows;
+  for (int start = 0; start != -1;) {
+    pageRows.push_back(rows.size());
+    start = wcWrapPage(doc, start, h.cols, h.rows, [&](int from, int to, int i) {
+      uint8_t flags = 0;
+      for (int k = from; k < to; k++) if (!printable(text[k])) flags = PACK_ROW_TEXT;
+      uint8_t color = o.rainbow ? PACK_MULTI | (i % RAINBOW_COLORS) : o.color;
+      rows.push_back(PackRow{ (uint32_t)from, (uint16_t)(to - from), color, flags });
+    });
+  }
+  pageRows.push_back(rows.size());
+  h.pages    = pageRows.size() - 1;
+  h.rowCount = rows.size();
+
+  int stride = (h.cols * h.charW + 7) / 8;
+  h.textOff  = PACK_HEADER;
+  h.textLen  = text.size();
+  h.rowOff   = h.textOff + h.textLen;
+  h.pageOff  = h.rowOff + h.rowCount * PACK_ROW_BYTES;
+  if (o.bitmaps) {
+    h.bitsRowBytes = stride * 8 * o.size;
+    h.bitsOff      = h.pageOff + (h.pages + 1) * 4;
+  }
+  uint32_t total = (h.bitsOff ? h.bitsOff + h.rowCount * h.bitsRowBytes : h.pageOff + (h.pages + 1) * 4);
+
+  std::vector<uint8_t> out(total);
+  memcpy(out.data() + h.textOff, text.data(), text.size());
+  for (uint32_t i = 0; i < h.rowCount; i++) {
+    uint8_t *e = out.data() + h.rowOff + i * PACK_ROW_BYTES;
+    wcPut32(e, rows[i].off);
+    wcPut16(e + 4, rows[i].len);
+    e[6] = rows[i].color;
+    e[7] = rows[i].flags;
+    if (h.bitsOff && !(rows[i].flags & PACK_ROW_TEXT))
+      renderRow(o.size, text.data() + rows[i].off, rows[i].len, stride, out.data() + h.bitsOff + i * h.bitsRowBytes);
+  }
+  for (uint32_t pg = 0; pg <= h.pages; pg++) wcPut32(out.data() + h.pageOff + pg * 4, pageRows[pg]);
+  wcPackEncodeHeader(h, out.data());
+  wcPut32(out.data() + PACK_CRC_AT, wcCrc32(0, out.data(), out.size()));
+
+  FILE *f = fopen(outPath, "wb");
+  if (!f || fwrite(out.data(), 1, out.size(), f) != out.size() || fclose(f) != 0) {
+    fprintf(stderr, "pagepack: can't write %s\n", outPath);
+    return 1;
+  }
+  printf("%s: %u pages, %u rows at size %d (%ux%u in a %dx%d pane), %u bytes (text %u, tables %u, bitmaps %u)\n",
+         outPath, h.pages, h.rowCount, o.size, h.cols, h.rows, o.paneW, o.paneH, total, h.textLen,
+         h.rowCount * PACK_ROW_BYTES + (h.pages + 1) * 4, h.bitsOff ? h.rowCount * h.bitsRowBytes : 0);
+  return check(outPath, o.dump);  // read it back the way the display will
+}
+
+static int usage() {
+  fprintf(stderr,
+          "usage: pagepack in.txt out.cydp [--size 1-3] [--pane W H] [--color 0-5 | --rainbow] [--bitmaps] [--dump]\n"
+          "       pagepack --check file.cydp [--dump]\n");
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  Options o;
+  std::vector<const char *> files;
+  bool checkOnly = false;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--size") && i + 1 < argc)                o.size = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--pane") && i + 2 < argc)           { o.paneW = atoi(argv[++i]); o.paneH = atoi(argv[++i]); }
+    else if (!strcmp(argv[i], "--color") && i + 1 < argc)          o.color = atoi(argv[++i]);
+    else if (!strcmp(argv[i], "--rainbow"))                        o.rainbow = true;
+    else if (!strcmp(argv[i], "--bitmaps"))                        o.bitmaps = true;
+    else if (!strcmp(argv[i], "--dump"))                           o.dump = true;
+    else if (!strcmp(argv[i], "--check"))                          checkOnly = true;
+    else if (argv[i][0] == '-')                                    return usage();
+    else                                                           files.push_back(argv[i]);
+  }
+  if (o.size < 1 || o.size > 3 || o.color < 0 || o.color > 5 || o.paneW < 1) return usage();
+  if (checkOnly) return files.size() == 1 ? check(files[0], o.dump) : usage();
+  return files.size() == 2 ? build(files[0], files[1], o) : usage();
+}
@@ -0,0 +1,327 @@
+#!/usr/bin/env python3
+"""A local stand-in for raw.githubusercontent.com, with fault injection.
+
+    python3 tools/rawserver.py --root test-files              # https://<ip>:8443/...
+    python3 tools/rawserver.py --root test-files --http --port 8080
+
+Files under --root are served at /<user>/<repo>/<branch>/<path>, like the
+real thing (a path that exists under --root as given works too). Point the
+display at it by setting its URL in the portal, e.g.
+https://192.168.1.50:8443/me/notes/main/status.txt.
+
+The display checks certificates, and its normal build only trusts GitHub's
+CAs. rawserver makes its own test CA on first start (rawserver-ca.pem next
+to this script, needs the openssl command) and on every start a P-256
+server certificate from it for this machine's name and addresses (--name
+adds more). The esp32dev-testca build trusts that CA as well; so does
+fetchbench.py's host client. --http avoids TLS altogether.
+
+What raw.githubusercontent.com does, and the display relies on:
+  ETag / If-None-Match -> 304, Range -> 206, gzip when the client asks,
+  Cache-Control, text/plain.
+
+Faults, chosen per request with a first path segment starting with '_':
+
+    /_drip=20000/me/notes/main/status.txt        20 KB/s
+    /_stall=4096:20,chunked/me/notes/...         chunked; 20 s pause after 4 KB
+
+  drip=BPS            send the body at BPS bytes per second
+  stall=OFFSET:SECS   stop for SECS seconds once OFFSET body bytes are out
+  truncate=OFFSET     close the connection after OFFSET bytes (the headers
+                      still announce the full length)
+  delay=SECS          wait before sending the headers
+  chunked             chunked transfer encoding instead of Content-Length
+  gzip                gzip even if the client didn't ask for it
+  redirect=N          N redirects (302) before the file
+  status=CODE         answer with CODE and no file (429, 500, 503 ...)
+
+Every request is logged with its timing. tools/fetchbench.py runs a set of
+these scenarios against a display and tabulates the results.
+"""
+import argparse
+import gzip
+import hashlib
+import http.server
+import os
+import socket
+import ssl
+import subprocess
+import sys
+import time
+from urllib.parse import urlsplit
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+CA = os.path.join(HERE, "rawserver-ca.pem")
+CA_KEY = os.path.join(HERE, "rawserver-ca-key.pem")
+CERT = os.path.join(HERE, "rawserver-cert.pem")
+KEY = os.path.join(HERE, "rawserver-key.pem")
+FLAGS = ("chunked", "gzip")  # faults without a value
+
+
+def parse_faults(segment):
+    faults = {}
+    for item in segment[1:].split(","):
+        if not item:
+            continue
+        name, _, value = item.partition("=")
+        faults[name] = value or "1"
+    return faults
+
+
+def openssl(*args, stdin=None):
+    subprocess.run(["openssl"] + list(args), input=stdin, check=True, stdout=subprocess.DEVNULL,
+                   stderr=subprocess.DEVNULL)
+
+
+def make_ca():
+    """The test CA, made once and kept: builds that trust it keep working."""
+    if os.path.exists(CA) and os.path.exists(CA_KEY):
+        return
+    print("rawserver: creating a test CA (%s)" % CA, file=sys.stderr)
+    openssl("req", "-x509", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:P-256", "-nodes", "-days", "3650",
+            "-subj", "/CN=rawserver test CA", "-addext", "basicConstraints=critical,CA:TRUE",
+            "-addext", "keyUsage=critical,keyCertSign,cRLSign", "-keyout", CA_KEY, "-out", CA)
+
+
+def local_names():
+    names = ["localhost", "127.0.0.1", socket.gethostname()]
+    s = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    try:
+        s.connect(("10.255.255.255", 1))  # no packet is sent
+        names.insert(0, s.getsockname()[0])
+    except OSError:
+        pass
+    finally:
+        s.close()
+    return names
+
+
+def make_cert(names=()):
+    """A P-256 server certificate from the test CA, for this machine's
+    names and addresses. The display matches addresses against DNS names
+    (its TLS library predates IP SANs), so addresses go in as both."""
+    make_ca()
+    names = list(dict.fromkeys(list(names) + local_names()))
+    san = []
+    for n in names:
+        san.append("DNS:" + n)
+        if n.replace(".", "").isdigit():
+            san.append("IP:" + n)
+    ext = ("basicConstraints=CA:FALSE\nkeyUsage=critical,digitalSignature\nextendedKeyUsage=serverAuth\n"
+           "subjectAltName=" + ",".join(san) + "\n")
+    ext_file = os.path.join(HERE, "rawserver-ext.tmp")
+    with open(ext_file, "w") as f:
+        f.write(ext)
+    try:
+        openssl("req", "-new", "-newkey", "ec", "-pkeyopt", "ec_paramgen_curve:P-256", "-nodes",
+                "-subj", "/CN=" + names[0], "-keyout", KEY, "-out", CERT + ".csr")
+        openssl("x509", "-req", "-in", CERT + ".csr", "-CA", CA, "-CAkey", CA_KEY, "-set_serial",
+                str(int.from_bytes(os.urandom(8), "big")), "-days", "825", "-sha256", "-extfile", ext_file,
+                "-out", CERT)
+    finally:
+        for tmp in (ext_file, CERT + ".csr"):
+            if os.path.exists(tmp):
+                os.remove(tmp)
+    return names
+
+
+class Handler(http.server.BaseHTTPRequestHandler):
+    protocol_version = "HTTP/1.1"
+    server_version = "rawserver"
+    root = "."
+    quiet = False
+
+    def log_message(self, fmt, *args):
+        pass  # handle_get() logs one line per request instead
+
+    def resolve(self, path):
+        parts = [p for p in path.split("/") if p and p not in (".", "..")]
+        for candidate in (parts, parts[3:]):
+            full = os.path.join(self.root, *candidate) if candidate else ""
+            if full and os.path.isfile(full):
+                return full
+        return None
+
+    def do_HEAD(self):
+        self.handle_get(head=True)
+
+    def do_GET(self):
+        self.handle_get(head=False)
+
+    def handle_get(self, head):
+        t0 = time.monotonic()
+        self.sent = 0
+        self.outcome = ""
+        path = urlsplit(self.path).path
+        faults = {}
+        if path.startswith("/_"):
+            first, _, rest = path[1:].partition("/")
+            faults = parse_faults(first)
+            path = "/" + rest
+        try:
+            self.respond(path, faults, head)
+        except (BrokenPipeError, ConnectionResetError):
+            self.outcome = "client went away"
+            self.close_connection = True
+        if self.quiet:
+            return
+        print("%s %s %s -> %s, %d body bytes in %.0f ms%s" % (
+            self.client_address[0], self.command, self.path, getattr(self, "code", "-"), self.sent,
+            (time.monotonic() - t0) * 1000, ", " + self.outcome if self.outcome else ""), file=sys.stderr)
+
+    def respond(self, path, faults, head):
+        if "delay" in faults:
+            time.sleep(float(faults["delay"]))
+        if "status" in faults:
+            return self.simple(int(faults["status"]), "injected status\n")
+        hops = int(faults.get("redirect", 0))
+        if hops > 0:
+            left = dict(faults, redirect=str(hops - 1))
+            if hops == 1:
+                del left["redirect"]
+            spec = ",".join(k if k in FLAGS else "%s=%s" % (k, v) for k, v in left.items())
+            self.code = 302
+            self.send_response(302)
+            self.send_header("Location", ("/_" + spec if spec else "") + path)
+            self.send_header("Content-Length", "0")
+            self.end_headers()
+            return
+
+        file = self.resolve(path)
+        if not file:
+            return self.simple(404, "404: Not Found")
+        with open(file, "rb") as f:
+            body = f.read()
+        etag = '"%s"' % hashlib.sha1(body).hexdigest()[:20]
+        zipped = "gzip" in faults or "gzip" in self.headers.get("Accept-Encoding", "")
+        if zipped:
+            etag = etag[:-1] + '-gzip"'
+
+        if self.headers.get("If-None-Match") == etag:
+            self.code = 304
+            self.send_response(304)
+            self.send_header("ETag", etag)
+            self.end_headers()
+            return
+
+        status, extra = 200, []
+        rng = self.headers.get("Range", "")
+        if rng.startswith("bytes=") and not zipped:
+            first, _, last = rng[6:].partition("-")
+            try:
+                if first:
+                    a, b = int(first), int(last) if last else len(body) - 1
+                else:
+                    a, b = len(body) - int(last), len(body) - 1
+                if a < 0 or a > b or a >= len(body):
+                    raise ValueError
+            except ValueError:
+                self.code = 416
+                self.send_response(416)
+                self.send_header("Content-Range", "bytes */%d" % len(body))
+                self.send_header("Content-Length", "0")
+                self.end_headers()
+                return
+            b = min(b, len(body) - 1)
+            status, extra = 206, [("Content-Range", "bytes %d-%d/%d" % (a, b, len(body)))]
+            body = body[a:b + 1]
+        if zipped:
+            body = gzip.compress(body, 6)
+            extra.append(("Content-Encoding", "gzip"))
+
+        chunked = "chunked" in faults
+        self.code = status
+        self.send_response(status)
+        self.send_header("Content-Type", "text/plain; charset=utf-8")
+        self.send_header("Cache-Control", "max-age=300")
+        self.send_header("ETag", etag)
+        self.send_header("Accept-Ranges", "bytes")
+        for k, v in extra:
+            self.send_header(k, v)
+        if chunked:
+            self.send_header("Transfer-Encoding", "chunked")
+        else:
+            self.send_header("Content-Length", str(len(body)))
+        self.end_headers()
+        if not head:
+            self.send_body(body, faults, chunked)
+
+    def simple(self, code, text):
+        data = text.encode()
+        self.code = code
+        self.send_response(code)
+        self.send_header("Content-Type", "text/plain; charset=utf-8")
+        self.send_header("Content-Length", str(len(data)))
+        self.end_headers()
+        self.wfile.write(data)
+
+    def send_body(self, body, faults, chunked):
+        bps = int(faults.get("drip", 0))
+        stall_at, stall_secs = -1, 0.0
+        if "stall" in faults:
+            at, _, secs = faults["stall"].partition(":")
+            stall_at, stall_secs = int(at), float(secs or 10)
+        cut = int(faults["truncate"]) if "truncate" in faults else -1
+        piece = max(1, bps // 20) if bps else 1460
+
+        pos, stalled = 0, False
+        while pos < len(body):
+            if pos == stall_at and not stalled:
+                self.outcome = "stalled %gs at %d" % (stall_secs, pos)
+                time.sleep(stall_secs)
+                stalled = True
+            n = min(piece, len(body) - pos)
+            if stall_at > pos:
+                n = min(n, stall_at - pos)
+            if cut >= 0:
+                n = min(n, cut - pos)
+                if n <= 0:
+                    self.outcome = "truncated"
+                    self.close_connection = True
+                    self.wfile.flush()
+                    return
+            data = body[pos:pos + n]
+            self.wfile.write(b"%x\r\n%s\r\n" % (len(data), data) if chunked else data)
+            self.wfile.flush()
+            pos += n
+            self.sent = pos
+            if bps:
+                time.sleep(n / bps)
+        if chunked:
+            self.wfile.write(b"0\r\n\r\n")
+
+
+def serve(root, port, use_tls, quiet=False, names=()):
+    Handler.root = root
+    Handler.quiet = quiet
+    httpd = http.server.ThreadingHTTPServer(("", port), Handler)
+    if use_tls:
+        names = make_cert(names)
+        ctx = ssl.SSLContext(ssl.PROTOCOL_TLS_SERVER)
+        ctx.load_cert_chain(CERT, KEY)
+        httpd.socket = ctx.wrap_socket(httpd.socket, server_side=True)
+    if not quiet:
+        print("rawserver: serving %s on %s://0.0.0.0:%d" % (root, "https" if use_tls else "http", port),
+              file=sys.stderr)
+        if use_tls:
+            print("rawserver: certificate for %s" % ", ".join(names), file=sys.stderr)
+    return httpd
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("--root", default=".", help="directory of files to serve")
+    ap.add_argument("--port", type=int, default=8443)
+    ap.add_argument("--http", action="store_true", help="plain HTTP instead of HTTPS")
+    ap.add_argument("--name", action="append", default=[],
+                    help="another host name or address for the certificate (repeatable)")
+    args = ap.parse_args()
+    httpd = serve(args.root, args.port, not args.http, names=args.name)
+    try:
+        httpd.serve_forever()
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    main()
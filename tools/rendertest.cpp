@@ -0,0 +1,208 @@
+// Golden-image test of the page renderer, run on the host. Draws test.txt
+// and the highlighted sources in tools/golden with the firmware's own render
+// code (Render.h) into an emulated ILI9341 (tools/host/HostPanel.h) at every
+// text size, in the dark theme and in the light one (inverted panel), and
+// checks each image against the CRCs in tools/golden/render.txt. Any change
+// to what ends up on screen fails it.
+//
+//   g++ -O2 -std=gnu++17 -Itools/host -Iinclude tools/rendertest.cpp -o rendertest
+//   ./rendertest                  # check against the goldens
+//   ./rendertest --png shots      # ... and save every image as PNG
+//   ./rendertest --update         # after a deliberate change: rewrite the goldens
+//
+// Run it from the repo root (or pass --text and --golden). Sizes 2 and 3
+// are also drawn the old way, through Arduino_GFX (wc_glyph_blit off), and
+// must give the same pixels as the pre-scaled glyphs. Highlighted pages
+// must end in the lexer state lexing the page in one go gives: the
+// split-close sources put a comment or string close across a row boundary
+// at each size. The bus counters per frame are printed alongside, as the
+// device logs them.
+//
+// The host Arduino_GFX (tools/host) draws only printable ASCII; the en
+// dashes in test.txt come out as blank cells, on the device as CP437 glyphs.
+#include <Arduino.h>
+#include <cstdio>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <HostPanel.h>
+#include "BusStats.h"
+#include "DocStore.h"
+#include "Render.h"
+
+#define TEST_PAGES 2  // pages of test.txt checked at each size
+
+// The text fields of a Pane (Dashboard.h): the whole text area between
+// status bar and footer, color 0
+struct Page {
+  int16_t         x = 0, y = 20, w = 320, h = 206;
+  int             textSize = 1;
+  int             colorIdx = 0;
+  const LexRules *lexRules = nullptr;
+  DocStore        body;
+};
+
+struct Options {
+  const char *text = "test.txt", *golden = "tools/golden/render.txt", *pngDir = nullptr;
+  bool        update = false;
+};
+
+// What is drawn: test.txt plain, and sources with a close cut by a row
+struct TestDoc {
+  const char     *path;
+  const LexRules *rules;
+  const char     *name;  // key prefix in the goldens, "" for test.txt
+};
+static TestDoc DOCS[] = {
+  { nullptr,                      nullptr, "" },  // --text
+  { "tools/golden/split-close.c",  &LEX_C,  "split-close.c " },
+  { "tools/golden/split-close.py", &LEX_PY, "split-close.py " },
+};
+
+static bool readFile(const char *path, std::string &out) {
+  std::ifstream in(path, std::ios::binary);
+  if (!in) return false;
+  std::stringstream ss;
+  ss << in.rdbuf();
+  out = ss.str();
+  return true;
+}
+
+// One frame the way the device draws it: theme on the panel, screen
+// cleared, then the page. lex is the lexer state at start in, at the end
+// of the page out. Returns the image CRC.
+static uint32_t render(HostPanel &panel, CountingBus &bus, Arduino_ILI9341 &tft, const Page &p, int start,
+                       uint8_t &lex) {
+  tft.invertDisplay(wc_theme->invert);
+  tft.fillScreen(wc_theme->bg);
+  bus.resetFrame();
+  wcLayoutPage(&tft, &bus, p, start, true, lex);
+  return panel.crc();
+}
+
+static std::string key(const TestDoc &d, int theme, int size, int page) {
+  char k[64];
+  snprintf(k, sizeof(k), "%s%s size %d page %d", d.name, theme == THEME_DARK ? "dark" : "light", size, page);
+  return k;
+}
+
+static int usage() {
+  fprintf(stderr, "usage: rendertest [--update] [--png dir] [--text test.txt] [--golden tools/golden/render.txt]\n");
+  return 2;
+}
+
+int main(int argc, char **argv) {
+  Options o;
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "--update"))                      o.update = true;
+    else if (!strcmp(argv[i], "--png") && i + 1 < argc)    o.pngDir = argv[++i];
+    else if (!strcmp(argv[i], "--text") && i + 1 < argc)   o.text = argv[++i];
+    else if (!strcmp(argv[i], "--golden") && i + 1 < argc) o.golden = argv[++i];
+    else                                                   return usage();
+  }
+
+  // "<theme> size <n> page <n> <crc>" per line, # comments
+  std::map<std::string, uint32_t> golden;
+  std::string goldenText;
+  if (!o.update) {
+    if (!readFile(o.golden, goldenText)) { fprintf(stderr, "rendertest: can't read %s\n", o.golden); return 1; }
+    std::istringstream in(goldenText);
+    for (std::string line; std::getline(in, line);) {
+      size_t sp = line.rfind(' ');
+      if (line.empty() || line[0] == '#' || sp == std::string::npos) continue;
+      golden[line.substr(0, sp)] = strtoul(line.c_str() + sp + 1, nullptr, 16);
+    }
+  }
+
+  HostPanel       panel;
+  CountingBus     bus(&panel);
+  Arduino_ILI9341 tft(&bus);
+  tft.begin();
+
+  std::string out = "# CRC-32 of the panel as seen, per tools/rendertest.cpp; ./rendertest --update rewrites it\n";
+  int failed = 0;
+  DOCS[0].path = o.text;
+  for (const TestDoc &d : DOCS) {
+    std::string text;
+    if (!readFile(d.path, text)) { fprintf(stderr, "rendertest: can't read %s\n", d.path); return 1; }
+    Page p;
+    p.lexRules = d.rules;
+    p.body.append((const uint8_t *)text.data(), text.size());
+    p.body.seal();
+
+    for (int theme = 0; theme < THEME_COUNT; theme++) {
+      wcThemeSelect(theme);
+      for (int size = 1; size <= 3; size++) {
+        p.textSize  = size;
+        int start   = 0;
+        uint8_t lex = LEXS_CODE;  // at start
+        for (int page = 1; page <= TEST_PAGES && start != -1; page++) {
+          std::string k = key(d, theme, size, page);
+          wc_glyph_blit = true;
+          uint8_t  end  = lex;
+          uint32_t crc  = render(panel, bus, tft, p, start, end);
+          BusCounters c = bus.frame;
+
+          printf("%-36s %08x  %6u transactions %6u commands %7u pixels %8u bytes", k.c_str(), crc,
+                 c.transactions, c.commands, c.pixels, c.bytes);
+          if (o.pngDir) {
+            std::string png = std::string(o.pngDir) + "/" + k + ".png";
+            for (char &ch : png) if (ch == ' ') ch = '-';
+            if (!panel.savePng(png.c_str())) { fprintf(stderr, "\nrendertest: can't write %s\n", png.c_str()); return 1; }
+          }
+
+          if (size >= 2) {
+            wc_glyph_blit  = false;
+            uint8_t  lex2  = lex;
+            uint32_t plain = render(panel, bus, tft, p, start, lex2);
+            if (plain != crc) {
+              printf("  FAIL: %08x through Arduino_GFX", plain);
+              failed++;
+            }
+          }
+
+          uint8_t tmp = lex;
+          int next = wcLayoutPage(&tft, &bus, p, start, false, tmp);
+          if (p.lexRules) {
+            uint8_t whole = lex;
+            wcLexSkip(*p.lexRules, p.body, start, next == -1 ? p.body.length() : next, p.body.length(), whole);
+            if (whole != end) {
+              printf("  FAIL: lexer state %u at the end, %u unwrapped", end, whole);
+              failed++;
+            }
+          }
+
+          char line[96];
+          snprintf(line, sizeof(line), "%s %08x\n", k.c_str(), crc);
+          out += line;
+          if (!o.update) {
+            auto g = golden.find(k);
+            if (g == golden.end())      { printf("  FAIL: no golden"); failed++; }
+            else if (g->second != crc)  { printf("  FAIL: golden %08x", g->second); failed++; }
+          }
+          printf("\n");
+
+          start = next;
+          lex   = end;
+        }
+      }
+    }
+  }
+
+  if (o.update) {
+    FILE *f = fopen(o.golden, "w");
+    if (!f || fputs(out.c_str(), f) < 0 || fclose(f) != 0) {
+      fprintf(stderr, "rendertest: can't write %s\n", o.golden);
+      return 1;
+    }
+    printf("wrote %s\n", o.golden);
+    return 0;
+  }
+  if (failed) {
+    printf("%d image(s) differ; look at them with --png, and if the change is intended run --update\n", failed);
+    return 1;
+  }
+  printf("all images match\n");
+  return 0;
+}
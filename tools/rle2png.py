@@ -0,0 +1,113 @@
+#!/usr/bin/env python3
+"""Turn a GithubRaw screenshot (GET /screen) into a PNG.
+
+    python3 tools/rle2png.py --url http://192.168.1.50/screen --token SECRET shot.png
+    curl -H "Authorization: Bearer SECRET" http://192.168.1.50/screen -o shot.cydr
+    python3 tools/rle2png.py shot.cydr shot.png
+
+The display reads its panel back and sends it run-length encoded; the
+format is described in include/Screenshot.h. With the light theme the
+panel is inverted, so the pixels are inverted again here to get what is
+actually on screen (--raw keeps them as stored). Standard library only.
+"""
+import argparse
+import struct
+import sys
+import time
+import urllib.request
+import zlib
+
+
+def decode(data):
+    """Returns (width, height, flags, list of RGB565 pixels)."""
+    if len(data) < 10 or data[:4] != b"CYDR":
+        raise ValueError("not a screenshot (no CYDR header)")
+    w, h, flags = struct.unpack_from("<HHB", data, 4)
+    pos, total, px = 10, w * h, []
+    while len(px) < total:
+        n = shift = 0
+        while True:
+            if pos >= len(data):
+                raise ValueError("truncated at pixel %d of %d" % (len(px), total))
+            b = data[pos]
+            pos += 1
+            n |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                break
+        count = n >> 1
+        if n & 1:
+            px.extend(struct.unpack_from("<H", data, pos) * count)
+            pos += 2
+        else:
+            px.extend(struct.unpack_from("<%dH" % count, data, pos))
+            pos += 2 * count
+    if len(px) != total:
+        raise ValueError("%d pixels for a %dx%d screen" % (len(px), w, h))
+    return w, h, flags, px
+
+
+def rgb888(c):
+    r, g, b = c >> 11, c >> 5 & 0x3F, c & 0x1F
+    return bytes(((r << 3) | (r >> 2), (g << 2) | (g >> 4), (b << 3) | (b >> 2)))
+
+
+def write_png(path, w, h, px):
+    lut = {}
+    rows = bytearray()
+    for y in range(h):
+        rows.append(0)  # filter: none
+        for c in px[y * w:(y + 1) * w]:
+            if c not in lut:
+                lut[c] = rgb888(c)
+            rows += lut[c]
+
+    def chunk(kind, body):
+        return struct.pack(">I", len(body)) + kind + body + struct.pack(">I", zlib.crc32(kind + body))
+
+    with open(path, "wb") as f:
+        f.write(b"\x89PNG\r\n\x1a\n")
+        f.write(chunk(b"IHDR", struct.pack(">IIBBBBB", w, h, 8, 2, 0, 0, 0)))
+        f.write(chunk(b"IDAT", zlib.compress(bytes(rows), 9)))
+        f.write(chunk(b"IEND", b""))
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("input", nargs="?", help="saved GET /screen response")
+    ap.add_argument("output", help="PNG to write")
+    ap.add_argument("--url", help="fetch from the display instead, e.g. http://<ip>/screen")
+    ap.add_argument("--token", help="the push token set in the portal")
+    ap.add_argument("--raw", action="store_true", help="don't undo the panel inversion")
+    args = ap.parse_args()
+
+    if args.url:
+        req = urllib.request.Request(args.url)
+        if args.token:
+            req.add_header("Authorization", "Bearer " + args.token)
+        t0 = time.monotonic()
+        with urllib.request.urlopen(req, timeout=30) as r:
+            data = r.read()
+        print("fetched %d bytes in %.0f ms" % (len(data), (time.monotonic() - t0) * 1000), file=sys.stderr)
+    elif args.input:
+        with open(args.input, "rb") as f:
+            data = f.read()
+    else:
+        ap.error("give an input file or --url")
+
+    try:
+        w, h, flags, px = decode(data)
+    except ValueError as e:
+        sys.exit("rle2png: %s" % e)
+    except struct.error:
+        sys.exit("rle2png: truncated")
+    if flags & 1 and not args.raw:
+        px = [~c & 0xFFFF for c in px]
+    write_png(args.output, w, h, px)
+    print("%dx%d%s, %d bytes encoded (%.1f %% of raw) -> %s" % (
+        w, h, " inverted" if flags & 1 else "", len(data), 100 * len(data) / (w * h * 2), args.output),
+        file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,202 @@
+#!/usr/bin/env python3
+"""Send a document to a GithubRaw display over USB serial (no WiFi needed).
+
+    python3 tools/serial_send.py /dev/ttyUSB0 status.txt
+    python3 tools/serial_send.py /dev/ttyUSB0 data.csv --baud 2000000
+
+The device must be running normally (not in the setup portal). The tool
+types `ingest <baud>` at the console, both ends switch to <baud>, and the
+file goes over in CRC-checked frames with a sliding window; lost or damaged
+frames are sent again. See include/SerialIngest.h for the protocol. Close
+`pio device monitor` first, only one program can hold the port.
+
+With --receive the tool plays the device instead and writes what it gets to
+a file, so both ends can be tried without hardware over a pty pair:
+
+    socat -d -d pty,raw,echo=0 pty,raw,echo=0      # prints two /dev/pts/N
+    python3 tools/serial_send.py --receive out.txt /dev/pts/3 &
+    python3 tools/serial_send.py /dev/pts/4 status.txt
+    cmp status.txt out.txt
+
+--noise 0.05 on the receiving side damages 5 % of frames to exercise the
+retransmits. Needs pyserial (pip install pyserial; PlatformIO ships it).
+"""
+import argparse
+import random
+import struct
+import sys
+import time
+import zlib
+
+import serial
+
+CONSOLE_BAUD = 115200
+SOF = 0xA5
+ACK_TIMEOUT = 0.5   # no ack for this long: go back and resend the window
+RETRIES = 10        # timeouts in a row before giving up
+DONE_TIMEOUT = 15   # the device lays out and draws the document before replying
+
+
+def frame(seq, payload):
+    head = struct.pack("<HH", seq & 0xFFFF, len(payload))
+    return bytes([SOF]) + head + payload + struct.pack("<I", zlib.crc32(head + payload))
+
+
+class Replies:
+    """Splits what the device sends into lines; '#' lines are protocol replies,
+    anything else is its log and is passed through to stderr."""
+
+    def __init__(self, ser, quiet):
+        self.ser = ser
+        self.quiet = quiet
+        self.buf = b""
+
+    def next(self, timeout):
+        end = time.monotonic() + timeout
+        while True:
+            nl = self.buf.find(b"\n")
+            if nl >= 0:
+                line, self.buf = self.buf[:nl].rstrip(b"\r"), self.buf[nl + 1:]
+                text = line.decode("utf-8", "replace")
+                if text.startswith("#"):
+                    return text.split()
+                if text and not self.quiet:
+                    print("  device: " + text, file=sys.stderr)
+                continue
+            if time.monotonic() >= end:
+                return None
+            self.buf += self.ser.read(max(1, self.ser.in_waiting))
+
+
+def send(port, data, baud, quiet):
+    ser = serial.Serial(port, CONSOLE_BAUD, timeout=0.05)
+    replies = Replies(ser, quiet)
+    ready = None
+    for _ in range(5):
+        ser.write(b"\n")  # wakes a device in light sleep; the console ignores blank lines
+        time.sleep(0.1)
+        ser.write(b"ingest %d\n" % baud)
+        ready = replies.next(3)
+        while ready and ready[0] not in ("#READY", "#FAIL"):
+            ready = replies.next(3)
+        if ready:
+            break
+    if not ready:
+        sys.exit("no reply from the device on %s" % port)
+    if ready[0] == "#FAIL":
+        sys.exit("device refused: " + " ".join(ready[1:]))
+    frame_max, window = int(ready[2]), int(ready[3])
+
+    ser.flush()
+    ser.baudrate = baud
+    time.sleep(0.05)  # let the device switch too
+
+    chunks = [data[i:i + frame_max] for i in range(0, len(data), frame_max)] + [b""]
+    base = nxt = 0       # oldest unacked frame, next frame to send
+    resent = timeouts = 0
+    t0 = time.monotonic()
+    while base < len(chunks):
+        while nxt < len(chunks) and nxt < base + window:
+            ser.write(frame(nxt, chunks[nxt]))
+            nxt += 1
+        reply = replies.next(ACK_TIMEOUT)
+        if reply is None:
+            timeouts += 1
+            if timeouts > RETRIES:
+                sys.exit("device stopped answering at frame %d" % base)
+            resent += nxt - base
+            nxt = base
+            continue
+        if reply[0] in ("#ACK", "#NAK"):
+            n = base + ((int(reply[1]) - base) & 0xFFFF)  # undo the 16-bit wrap
+            if n > nxt:
+                continue  # stale
+            if n > base:
+                base, timeouts = n, 0
+            if reply[0] == "#NAK":
+                resent += nxt - base
+                nxt = base
+        elif reply[0] == "#FAIL":
+            sys.exit("device failed: " + " ".join(reply[1:]))
+
+    done = replies.next(DONE_TIMEOUT)
+    while done and done[0] not in ("#DONE", "#FAIL"):
+        done = replies.next(DONE_TIMEOUT)
+    secs = time.monotonic() - t0
+    ser.flush()
+    ser.baudrate = CONSOLE_BAUD
+    if not done or done[0] != "#DONE":
+        sys.exit("transfer failed: " + (" ".join(done[1:]) if done else "no reply"))
+    print("%d bytes in %.2f s (%.0f B/s, %.0f %% of line rate at %d baud), %d frames resent, %s" % (
+        len(data), secs, len(data) / secs, 100 * len(data) / secs / (baud / 10), baud, resent,
+        "shown" if done[2] == "1" else "unchanged"))
+
+
+def receive(port, out, noise):
+    """The device side, for testing without hardware."""
+    ser = serial.Serial(port, CONSOLE_BAUD, timeout=3)
+    while True:
+        line = ser.readline().decode("utf-8", "replace").split()
+        if line and line[0] == "ingest":
+            break
+    baud = int(line[1]) if len(line) > 1 else CONSOLE_BAUD
+    ser.write(b"#READY %d 512 4\n" % baud)
+    ser.flush()
+    ser.baudrate = baud
+
+    doc = bytearray()
+    expect, naked, t0 = 0, False, time.monotonic()
+    while True:
+        b = ser.read(1)
+        if not b:
+            ser.write(b"#FAIL timeout\n")
+            sys.exit("timeout")
+        if b[0] != SOF:
+            continue
+        head = ser.read(4)
+        seq, length = struct.unpack("<HH", head)
+        body = ser.read(length + 4) if length <= 512 else b""
+        ok = len(body) == length + 4 and zlib.crc32(head + body[:length]) == struct.unpack("<I", body[length:])[0]
+        if ok and random.random() < noise:
+            ok = False
+        if not ok or seq != expect:
+            if ok and ((expect - seq) & 0xFFFF) < 0x8000:
+                ser.write(b"#ACK %d\n" % expect)
+            elif not naked:
+                ser.write(b"#NAK %d\n" % expect)
+                naked = True
+            continue
+        expect = (expect + 1) & 0xFFFF
+        naked = False
+        ser.write(b"#ACK %d\n" % expect)
+        if length == 0:
+            break
+        doc += body[:length]
+    with open(out, "wb") as f:
+        f.write(doc)
+    ser.write(b"#DONE %d 1 %d\n" % (len(doc), (time.monotonic() - t0) * 1000))
+    ser.flush()
+    print("received %d bytes into %s" % (len(doc), out), file=sys.stderr)
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    ap.add_argument("port")
+    ap.add_argument("file", nargs="?", help="document to send")
+    ap.add_argument("--baud", type=int, default=921600,
+                    help="transfer baud: 115200, 230400, 460800, 921600 (default), 1500000, 2000000")
+    ap.add_argument("--quiet", action="store_true", help="don't echo the device's log")
+    ap.add_argument("--receive", metavar="OUT", help="act as the device and write the document to OUT")
+    ap.add_argument("--noise", type=float, default=0, help="with --receive: fraction of frames to reject")
+    args = ap.parse_args()
+    if args.receive:
+        receive(args.port, args.receive, args.noise)
+    elif args.file:
+        with open(args.file, "rb") as f:
+            send(args.port, f.read(), args.baud, args.quiet)
+    else:
+        ap.error("give a file to send, or --receive OUT")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,28 @@
+"""PlatformIO pre-build script for env:esp32dev-testca.
+
+Makes sure tools/rawserver.py's test CA exists and hands it to the firmware
+as TestCA.h (TLS_TEST_CA_PEM, appended to the trust set in TrustStore.h),
+so the display accepts rawserver's certificates as well as GitHub's. The
+header goes to the build directory, never into the tree.
+"""
+import os
+import sys
+
+Import("env")  # noqa: F821 (provided by PlatformIO)
+
+TOOLS = os.path.join(env.subst("$PROJECT_DIR"), "tools")  # noqa: F821
+sys.path.insert(0, TOOLS)
+import rawserver  # noqa: E402
+
+rawserver.make_ca()
+out_dir = os.path.join(env.subst("$BUILD_DIR"), "testca")  # noqa: F821
+os.makedirs(out_dir, exist_ok=True)
+with open(rawserver.CA) as f:
+    pem = f.read().strip().splitlines()
+with open(os.path.join(out_dir, "TestCA.h"), "w") as f:
+    f.write("#pragma once\n// Generated by tools/testca.py from %s\n" % os.path.basename(rawserver.CA))
+    f.write("#define TLS_TEST_CA_PEM \\\n")
+    f.write("".join('  "%s\\n" \\\n' % line for line in pem))
+    f.write("  \"\"\n")
+env.Append(CPPPATH=[out_dir])  # noqa: F821
+print("testca: trusting %s" % rawserver.CA)
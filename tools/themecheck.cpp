@@ -0,0 +1,68 @@
+// Theme check, run on the host: every color of every theme in Theme.h is
+// drawn on the emulated panel (tools/host/HostPanel.h) with the theme's
+// inversion, and what shows on the glass must be the color the theme was
+// written with (DARK_COLORS, LIGHT_COLORS). Theme.h's static_asserts check
+// the tables; this checks them through invertDisplay() and the panel, and
+// that the fixed RGB565_BLACK the render code clears panes with (Render.h)
+// shows as each theme's background.
+//
+//   g++ -O2 -std=gnu++17 -Itools/host -Iinclude tools/themecheck.cpp -o themecheck
+//   ./themecheck          # exit 1 on any mismatch
+//   ./themecheck -v       # list every color
+#include <Arduino.h>
+#include <cstdio>
+#include <HostPanel.h>
+#include "Theme.h"
+
+static const ThemeColors *const INTENDED[THEME_COUNT] = { &DARK_COLORS, &LIGHT_COLORS };
+
+static HostPanel       panel;
+static Arduino_ILI9341 tft(&panel);
+static bool            verbose = false;
+static int             failed  = 0;
+
+// Draw drawn on the panel, read it back as seen and compare with want
+static void check(const char *theme, const char *what, int i, uint16_t drawn, uint16_t want) {
+  tft.fillRect(10, 10, 4, 4, drawn);
+  uint16_t seen = panel.shown(11, 11);
+  bool ok = seen == want;
+  if (!ok) failed++;
+  if (verbose || !ok)
+    printf("%-6s %-9s %d  drawn %04X  seen %04X  want %04X%s\n", theme, what, i, drawn, seen, want, ok ? "" : "  FAIL");
+}
+
+template <int N>
+static void check(const char *theme, const char *what, const Palette<N> &drawn, const Palette<N> &want) {
+  for (int i = 0; i < N; i++) check(theme, what, i, drawn[i], want[i]);
+}
+
+int main(int argc, char **argv) {
+  for (int i = 1; i < argc; i++) {
+    if (!strcmp(argv[i], "-v")) verbose = true;
+    else { fprintf(stderr, "usage: themecheck [-v]\n"); return 2; }
+  }
+  tft.begin();
+
+  for (int t = 0; t < THEME_COUNT; t++) {
+    const Theme       &th   = THEMES[t];
+    const ThemeColors &want = *INTENDED[t];
+    const char        *name = t == THEME_DARK ? "dark" : "light";
+    tft.invertDisplay(th.invert);
+
+    check(name, "bg", 0, th.bg, want.bg);
+    check(name, "clear", 0, RGB565_BLACK, want.bg);
+    check(name, "ink", 0, th.ink, want.ink);
+    check(name, "gray", 0, th.gray, wcBlend565(want.bg, want.ink, 124));
+    check(name, "rule", 0, th.rule, wcBlend565(want.bg, want.ink, 59));
+    check(name, "text", th.text, want.text);
+    check(name, "multi", th.multi, want.multi);
+    check(name, "highlight", th.highlight, want.highlight);
+  }
+
+  if (failed) {
+    printf("%d color(s) wrong on screen\n", failed);
+    return 1;
+  }
+  printf("all theme colors show as intended\n");
+  return 0;
+}
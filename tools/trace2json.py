@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Convert a GithubRaw trace dump to Chrome trace_event JSON.
+
+Capture the dump from the serial monitor after typing `trace`, e.g.
+
+    pio device monitor | tee trace.log      # then type: trace
+    python3 tools/trace2json.py trace.log > trace.json
+
+and open trace.json in chrome://tracing or https://ui.perfetto.dev.
+Lines that aren't part of the dump are ignored, so a whole serial log works.
+Each boot becomes its own process on the timeline (timestamps restart at a
+reset); the two ESP32 cores are its threads.
+"""
+import json
+import sys
+
+PHASES = {0: "i", 1: "B", 2: "E"}
+
+
+def convert(lines):
+    names = {}
+    events = []
+    boots = set()
+    last_ts = {}  # boot -> (raw ts, wrap offset) to undo 32-bit wraparound
+    for line in lines:
+        parts = line.split()
+        if len(parts) == 3 and parts[0] == "N":
+            names[int(parts[1])] = parts[2]
+            continue
+        if len(parts) != 7 or parts[0] != "E":
+            continue
+        boot, core, phase, ev, ts, arg = (int(p) for p in parts[1:])
+        # The two cores' records can be a few us out of order, so going
+        # back only counts as a wrap when it is more than half the range
+        prev, offset = last_ts.get(boot, (ts, 0))
+        if (ts - prev) & 0xFFFFFFFF < 1 << 31:  # forward, maybe across a wrap
+            if ts < prev:
+                offset += 1 << 32
+            last_ts[boot] = (ts, offset)
+        elif ts > prev:  # a late record from before the last wrap
+            offset -= 1 << 32
+        boots.add(boot)
+        e = {
+            "name": names.get(ev, "event%d" % ev),
+            "ph": PHASES.get(phase, "i"),
+            "ts": ts + offset,
+            "pid": boot,
+            "tid": core,
+            "args": {"arg": arg},
+        }
+        if e["ph"] == "i":
+            e["s"] = "t"
+        events.append(e)
+    for boot in sorted(boots):
+        events.append({"name": "process_name", "ph": "M", "pid": boot,
+                       "args": {"name": "boot %d" % boot}})
+        for core in (0, 1):
+            events.append({"name": "thread_name", "ph": "M", "pid": boot, "tid": core,
+                           "args": {"name": "core %d" % core}})
+    return {"traceEvents": events, "displayTimeUnit": "ms"}
+
+
+def main():
+    src = open(sys.argv[1], errors="replace") if len(sys.argv) > 1 else sys.stdin
+    json.dump(convert(src), sys.stdout, indent=1)
+    sys.stdout.write("\n")
+
+
+if __name__ == "__main__":
+    main()